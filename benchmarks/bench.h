@@ -0,0 +1,49 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+#include "vertex.h"
+
+// Lowest wall clock time over a number of runs of fn, in milliseconds. Taking the
+// fastest run filters out most of the noise from other processes
+template <typename Function>
+double bestOf(unsigned runs, Function&& fn)
+{
+    double best = 1e30;
+    for (unsigned i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Stops the optimiser from discarding work whose result is otherwise unused
+inline void keep(double value)
+{
+    static volatile double sink = 0.0;
+    sink = sink + value;
+}
+
+// The vertex hash from before hashVertex, which let neighbouring components cancel out
+struct LegacyVertexHash
+{
+    size_t operator()(const vertex& v) const {
+        return std::hash<float>()(v.x) ^ (std::hash<float>()(v.y) << 1) ^ (std::hash<float>()(v.z) << 2) ^ (std::hash<float>()(v.u) << 3) ^ (std::hash<float>()(v.v) << 4) ^ (std::hash<float>()(v.nx) << 5) ^ (std::hash<float>()(v.ny) << 6) ^ (std::hash<float>()(v.nz) << 7);
+    }
+};
+
+void benchChunkMesh();
+void benchChunkGenerator();
+void benchHeightmap();
+void benchTerrainNormals();
+void benchObjLoader();
+void benchVertexMap();
+void benchRenderQueue();
+void benchCulling();
+
+#endif
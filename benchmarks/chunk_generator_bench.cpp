@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "chunk_generator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// Keeps a 16x16 window of chunks loaded around a camera that moves one chunk along x
+// every few frames, the same way ChunkManager does, with frames paced at 60 Hz. Chunks
+// that leave the window while still queued are cancelled. Reports the worst time the
+// frame thread spent on chunks in one frame, and checks that every chunk of the final
+// window arrived exactly once
+static void runRing(const World& world, unsigned numThreads, bool onFrameThread)
+{
+    const int window = 16;
+    const int steps = 16;
+    const int framesPerStep = 4;
+    const unsigned maxPerFrame = 8;
+    const std::chrono::microseconds frameTime(16667);
+
+    ChunkGenerator generator(world, numThreads);
+    std::unordered_map<ChunkCoord, std::shared_ptr<std::atomic<bool>>> pending;
+    std::unordered_set<ChunkCoord> resident;
+    std::vector<GeneratedChunk> finished;
+
+    unsigned generated = 0;
+    unsigned duplicates = 0;
+    unsigned cancelled = 0;
+    double worstFrame = 0.0;
+    unsigned frames = 0;
+
+    auto inWindow = [&](ChunkCoord coord, int cameraX) {
+        return coord.x >= cameraX - window / 2 && coord.x < cameraX + window / 2 
+            && coord.y >= -window / 2 && coord.y < window / 2;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto nextFrame = start;
+
+    for (int step = 0; step <= steps || !pending.empty(); step++) {
+        int cameraX = std::min(step, steps);
+
+        for (int frame = 0; frame < framesPerStep; frame++, frames++) {
+            auto frameStart = std::chrono::steady_clock::now();
+
+            for (auto it = resident.begin(); it != resident.end();) {
+                it = inWindow(*it, cameraX) ? std::next(it) : resident.erase(it);
+            }
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (inWindow(it->first, cameraX)) {
+                    ++it;
+                    continue;
+                }
+                it->second->store(true, std::memory_order_relaxed);
+                it = pending.erase(it);
+                cancelled++;
+            }
+
+            for (int y = -window / 2; y < window / 2; y++) {
+                for (int x = cameraX - window / 2; x < cameraX + window / 2; x++) {
+                    ChunkCoord coord = {x, y};
+                    if (resident.count(coord) || pending.count(coord)) {
+                        continue;
+                    }
+
+                    if (onFrameThread) {
+                        // What the frame thread paid before the worker pool
+                        ChunkMesh mesh;
+                        Heightmap heights = world.generateChunk(x, y);
+                        world.buildChunkMesh(heights.view(), mesh);
+                        resident.insert(coord);
+                        generated++;
+                        continue;
+                    }
+
+                    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+                    pending[coord] = flag;
+                    generator.request(coord, flag);
+                }
+            }
+
+            finished.clear();
+            generator.drain(maxPerFrame, finished);
+            for (GeneratedChunk& chunk : finished) {
+                pending.erase(chunk.coord);
+                duplicates += !resident.insert(chunk.coord).second;
+                generated++;
+            }
+
+            std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - frameStart;
+            worstFrame = std::max(worstFrame, spent.count());
+
+            nextFrame += frameTime;
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    // Cancelled chunks still pass through the queue, so wait for the last of them
+    while (generator.pending() > 0) {
+        finished.clear();
+        generator.drain(maxPerFrame, finished);
+        duplicates += finished.size();
+        std::this_thread::yield();
+    }
+
+    std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - start;
+
+    bool complete = resident.size() == (size_t)(window * window);
+    for (ChunkCoord coord : resident) {
+        complete = complete && inWindow(coord, steps);
+    }
+
+    if (onFrameThread) {
+        std::cout << "inline on the frame thread:";
+    }
+    else {
+        std::cout << generator.numThreads() << " worker" << (generator.numThreads() == 1 ? ": " : "s:");
+    }
+    std::cout << " worst frame " << worstFrame << " ms, " << frames << " frames in " << total.count() 
+        << " ms, " << generated << " chunks built, " << cancelled << " cancelled, " 
+        << (complete && duplicates == 0 ? "window complete" : "WINDOW WRONG") << std::endl;
+}
+
+void benchChunkGenerator()
+{
+    World world(0, 64, 2, 32);
+
+    runRing(world, 1, true);
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        runRing(world, threads, false);
+    }
+}
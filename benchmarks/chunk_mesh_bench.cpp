@@ -0,0 +1,194 @@
+#include "bench.h"
+#include "gl_stubs.h"
+#include "world.h"
+#include "terrain_buffers.h"
+#include "terrain_indices.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <vector>
+
+// World::drawChunk as it was before chunk meshes were kept on the GPU, called every frame.
+// It took the heightmap by value, rebuilt every vertex, index and normal, then created,
+// filled, drew and deleted a VAO, VBO and EBO. The vertex and index arrays were stack
+// arrays, vectors here since a 400x400 chunk needs 7 MB of them
+static void legacyDrawChunk(std::vector<std::vector<float>> chunk, unsigned int program)
+{
+    int x_width = chunk.size();
+    int z_width = chunk[0].size();
+
+    std::vector<float> vertices(x_width * z_width * 6);
+    std::vector<int> indices((x_width-1) * (z_width-1) * 6);
+
+    int index_pos = 0;
+
+    for (int x = 0; x < x_width; x++) {
+        for (int z = 0; z < z_width; z++) {
+            int pos = 6 * (x * z_width + z);
+
+            vertices[pos] = x;
+            vertices[pos+1] = chunk[x][z];
+            vertices[pos+2] = z;
+
+            vertices[pos+3] = 0.0f;
+            vertices[pos+4] = 0.0f;
+            vertices[pos+5] = 0.0f;
+
+            if (x < x_width - 1 && z < z_width - 1) {
+                indices[index_pos] = x * z_width + z;
+                indices[index_pos+1] = (x+1) * z_width + z;
+                indices[index_pos+2] = x * z_width + z + 1;
+
+                indices[index_pos+3] = (x+1) * z_width + z;
+                indices[index_pos+4] = (x+1) * z_width + z + 1;
+                indices[index_pos+5] = x * z_width + z + 1;
+
+                index_pos += 6;
+            }
+        }
+    }
+
+    for (int x = 0; x < x_width - 1; x++) {
+        for (int z = 0; z < z_width - 1; z++) {
+            int top_left_pos = 6 * (x * z_width + z);
+            int top_right_pos = 6 * (x * z_width + (z+1));
+            int bottom_left_pos = 6 * ((x+1) * z_width + z);
+            int bottom_right_pos = 6 * ((x+1) * z_width + (z+1));
+
+            vec3 top_left = vec3(vertices[top_left_pos], vertices[top_left_pos + 1], vertices[top_left_pos + 2]);
+            vec3 top_right = vec3(vertices[top_right_pos], vertices[top_right_pos + 1], vertices[top_right_pos + 2]);
+            vec3 bottom_left = vec3(vertices[bottom_left_pos], vertices[bottom_left_pos + 1], vertices[bottom_left_pos + 2]);
+            vec3 bottom_right = vec3(vertices[bottom_right_pos], vertices[bottom_right_pos + 1], vertices[bottom_right_pos + 2]);
+
+            vec3 top_triangle_normal = (top_right - top_left).cross(bottom_left - top_left).normalize();
+            vec3 bottom_triangle_normal = (bottom_left - bottom_right).cross(top_right - bottom_right).normalize();
+
+            vertices[top_left_pos + 3] += top_triangle_normal.x;
+            vertices[top_left_pos + 4] += top_triangle_normal.y;
+            vertices[top_left_pos + 5] += top_triangle_normal.z;
+
+            vertices[top_right_pos + 3] += top_triangle_normal.x + bottom_triangle_normal.x;
+            vertices[top_right_pos + 4] += top_triangle_normal.y + bottom_triangle_normal.y;
+            vertices[top_right_pos + 5] += top_triangle_normal.z + bottom_triangle_normal.z;
+
+            vertices[bottom_left_pos + 3] += top_triangle_normal.x + bottom_triangle_normal.x;
+            vertices[bottom_left_pos + 4] += top_triangle_normal.y + bottom_triangle_normal.y;
+            vertices[bottom_left_pos + 5] += top_triangle_normal.z + bottom_triangle_normal.z;
+
+            vertices[bottom_right_pos + 3] += bottom_triangle_normal.x;
+            vertices[bottom_right_pos + 4] += bottom_triangle_normal.y;
+            vertices[bottom_right_pos + 5] += bottom_triangle_normal.z;
+        }
+    }
+
+    for (int i = 0; i < x_width * z_width; i++) {
+        int pos = 6 * i;
+        vec3 normal = vec3(vertices[pos+3], vertices[pos+4], vertices[pos+5]).normalize();
+        vertices[pos+3] = normal.x;
+        vertices[pos+4] = normal.y;
+        vertices[pos+5] = normal.z;
+    }
+
+    unsigned int VAO, VBO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(int), indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glUseProgram(program);
+    mat4 model = mat4::translate(vec3(0.0f, 0.0f, 0.0f));
+    int modelLoc = glGetUniformLocation(program, "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_TRUE, model.m);
+
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+static void report(const char* path, double time, const GLStubCounters& counters)
+{
+    std::cout << path << ": " << time << " ms, " << counters.calls << " GL calls, " 
+        << counters.objects << " objects created, " << counters.bytesUploaded << " bytes uploaded, " 
+        << counters.draws << " draw" << (counters.draws == 1 ? "" : "s") << std::endl;
+}
+
+// Frame cost of drawing one 400x400 chunk, the size the old main drew, through the old
+// path and through the resident mesh path ChunkManager uses. GL goes to the counting
+// stubs, so times are the CPU side of a frame, including the copy a driver makes of
+// uploaded data, and the counters are per frame
+void benchChunkMesh()
+{
+    installGLStubs();
+
+    World world(0, 200, 2, 32);
+    Heightmap heights = world.generateChunk(0, 0);
+    const unsigned width = world.getChunkWidth();
+
+    // The old chunks had no shared far edge or apron, and were indexed [x][z]
+    std::vector<std::vector<float>> legacyHeights(width, std::vector<float>(width));
+    for (unsigned z = 0; z < width; z++) {
+        for (unsigned x = 0; x < width; x++) {
+            legacyHeights[x][z] = heights.at(x + 1, z + 1);
+        }
+    }
+
+    GLStubCounters legacyCounters;
+    double legacy = bestOf(5, [&] {
+        glStubs = GLStubCounters();
+        legacyDrawChunk(legacyHeights, 1);
+        legacyCounters = glStubs;
+    });
+
+    // The indices are built once for every chunk of the same size
+    TerrainBuffers terrainBuffers((width + 1) * (width + 1));
+    TerrainIndexBuffers indexBuffers((width + 1) * (width + 1));
+    indexBuffers.get(width + 1, width + 1);
+
+    // Each mesh is built and uploaded once, when its chunk comes into range
+    ChunkMesh mesh;
+    glStubs = GLStubCounters();
+    double build = bestOf(1, [&] {
+        world.buildChunkMesh(heights.view(), mesh);
+        mesh.upload(terrainBuffers);
+    });
+    GLStubCounters buildCounters = glStubs;
+
+    GLStubCounters residentCounters;
+    double resident = bestOf(50, [&] {
+        glStubs = GLStubCounters();
+        terrainBuffers.clearDraws();
+        terrainBuffers.addDraw(mesh.origin, mesh.width, mesh.getFirstVertex(), indexBuffers.get(mesh.width, mesh.height));
+
+        glUseProgram(1);
+        glBindVertexArray(terrainBuffers.getVAO());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffers.getEBO());
+        terrainBuffers.draw(indexBuffers.getType(), indexBuffers.getIndexSize());
+        glBindVertexArray(0);
+        residentCounters = glStubs;
+    });
+
+    report("old path, every frame", legacy, legacyCounters);
+    report("resident mesh, every frame", resident, residentCounters);
+    report("resident mesh, once when it comes into range", build, buildCounters);
+
+    mesh.release(terrainBuffers);
+    terrainBuffers.release();
+    indexBuffers.release();
+}
@@ -0,0 +1,50 @@
+#include "bench.h"
+#include "culling.h"
+#include "maths/maths.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Culls randomly placed boxes one at a time with frustum::intersects and together with
+// BoundsBatch, and checks both keep the same boxes
+void benchCulling()
+{
+    const unsigned count = 100000;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> size(1.0f, 10.0f);
+
+    std::vector<aabb> boxes;
+    BoundsBatch batch;
+    for (unsigned i = 0; i < count; i++) {
+        vec3 min(position(rng), position(rng) * 0.05f, position(rng));
+        boxes.push_back(aabb(min, min + vec3(size(rng), size(rng), size(rng))));
+        batch.add(boxes.back());
+    }
+
+    mat4 projection = mat4::projection(45.0f, 16.0f / 9.0f, 0.1f, 10000.0f);
+    mat4 view = mat4::lookAt(vec3(0.0f, 20.0f, 0.0f), vec3(100.0f, 10.0f, 100.0f), vec3(0.0f, 1.0f, 0.0f));
+    frustum camera = frustum::fromMatrix(projection * view);
+
+    std::vector<unsigned char> single(count);
+    std::vector<unsigned char> batched(count);
+
+    double each = bestOf(20, [&] {
+        for (unsigned i = 0; i < count; i++) {
+            single[i] = camera.intersects(boxes[i]);
+        }
+    });
+    double together = bestOf(20, [&] { batch.cull(camera, batched); });
+
+    unsigned visible = 0;
+    for (unsigned char v : batched) {
+        visible += v;
+    }
+
+    std::cout << count << " boxes, " << visible << " visible, results " << (single == batched ? "identical" : "DIFFER") 
+        << std::endl;
+    std::cout << "frustum::intersects " << each << " ms, BoundsBatch " << together << " ms (" << each / together 
+        << "x)" << std::endl;
+}
@@ -0,0 +1,103 @@
+#include "gl_stubs.h"
+
+#include <cstring>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+GLStubCounters glStubs;
+
+// Stands in for driver memory, so uploads cost a copy
+static std::vector<char> uploadCopy;
+
+static void upload(const void* data, size_t size)
+{
+    glStubs.bytesUploaded += size;
+    if (data) {
+        if (uploadCopy.size() < size) {
+            uploadCopy.resize(size);
+        }
+        std::memcpy(uploadCopy.data(), data, size);
+    }
+}
+
+static void APIENTRY stubUseProgram(GLuint) { glStubs.calls++; glStubs.binds++; }
+static void APIENTRY stubBindTexture(GLenum, GLuint) { glStubs.calls++; glStubs.binds++; }
+static void APIENTRY stubBindVertexArray(GLuint array) { glStubs.calls++; glStubs.binds += array != 0; }
+static void APIENTRY stubBindBuffer(GLenum, GLuint) { glStubs.calls++; glStubs.binds++; }
+static void APIENTRY stubActiveTexture(GLenum) { glStubs.calls++; }
+
+static void APIENTRY stubDrawElements(GLenum, GLsizei, GLenum, const void*) { glStubs.calls++; glStubs.draws++; }
+static void APIENTRY stubDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) { glStubs.calls++; glStubs.draws++; }
+static void APIENTRY stubDrawElementsBaseVertex(GLenum, GLsizei, GLenum, const void*, GLint) { glStubs.calls++; glStubs.draws++; }
+
+static void APIENTRY stubGenObjects(GLsizei n, GLuint* names)
+{
+    static GLuint next = 1;
+    glStubs.calls++;
+    for (GLsizei i = 0; i < n; i++) {
+        names[i] = next++;
+        glStubs.objects++;
+    }
+}
+static void APIENTRY stubDeleteObjects(GLsizei, const GLuint*) { glStubs.calls++; }
+
+static void APIENTRY stubBufferData(GLenum, GLsizeiptr size, const void* data, GLenum) { glStubs.calls++; upload(data, size); }
+static void APIENTRY stubBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void* data) { glStubs.calls++; upload(data, size); }
+static void APIENTRY stubCopyBufferSubData(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr) { glStubs.calls++; }
+
+static void APIENTRY stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { glStubs.calls++; }
+static void APIENTRY stubVertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) { glStubs.calls++; }
+static void APIENTRY stubEnableVertexAttribArray(GLuint) { glStubs.calls++; }
+static void APIENTRY stubVertexAttribDivisor(GLuint, GLuint) { glStubs.calls++; }
+
+static GLint APIENTRY stubGetUniformLocation(GLuint, const GLchar*) { glStubs.calls++; return 0; }
+static void APIENTRY stubUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { glStubs.calls++; }
+
+static void APIENTRY stubGetIntegerv(GLenum name, GLint* value)
+{
+    glStubs.calls++;
+    *value = name == GL_MAJOR_VERSION ? 3 : name == GL_MINOR_VERSION ? 3 : 0;
+}
+static const GLubyte* APIENTRY stubGetStringi(GLenum, GLuint) { glStubs.calls++; return nullptr; }
+
+// TerrainBuffers loads glMultiDrawElementsIndirect through GLFW. The stub context never
+// offers it, so no window library is needed
+GLFWglproc glfwGetProcAddress(const char*)
+{
+    return nullptr;
+}
+
+void installGLStubs()
+{
+    glad_glUseProgram = stubUseProgram;
+    glad_glBindTexture = stubBindTexture;
+    glad_glBindVertexArray = stubBindVertexArray;
+    glad_glBindBuffer = stubBindBuffer;
+    glad_glActiveTexture = stubActiveTexture;
+
+    glad_glDrawElements = stubDrawElements;
+    glad_glDrawElementsInstanced = stubDrawElementsInstanced;
+    glad_glDrawElementsBaseVertex = stubDrawElementsBaseVertex;
+
+    glad_glGenVertexArrays = stubGenObjects;
+    glad_glGenBuffers = stubGenObjects;
+    glad_glDeleteVertexArrays = stubDeleteObjects;
+    glad_glDeleteBuffers = stubDeleteObjects;
+
+    glad_glBufferData = stubBufferData;
+    glad_glBufferSubData = stubBufferSubData;
+    glad_glCopyBufferSubData = stubCopyBufferSubData;
+
+    glad_glVertexAttribPointer = stubVertexAttribPointer;
+    glad_glVertexAttribIPointer = stubVertexAttribIPointer;
+    glad_glEnableVertexAttribArray = stubEnableVertexAttribArray;
+    glad_glVertexAttribDivisor = stubVertexAttribDivisor;
+
+    glad_glGetUniformLocation = stubGetUniformLocation;
+    glad_glUniformMatrix4fv = stubUniformMatrix4fv;
+
+    glad_glGetIntegerv = stubGetIntegerv;
+    glad_glGetStringi = stubGetStringi;
+}
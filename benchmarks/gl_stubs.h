@@ -0,0 +1,25 @@
+#ifndef GL_STUBS_H
+#define GL_STUBS_H
+
+#include <cstddef>
+
+// What the stubbed GL functions were asked to do since the counters were last reset
+struct GLStubCounters
+{
+    unsigned calls = 0;
+    // Program, texture, vertex array and buffer binds. Unbinding a vertex array is not counted
+    unsigned binds = 0;
+    unsigned draws = 0;
+    // Objects created with glGen*
+    unsigned objects = 0;
+    size_t bytesUploaded = 0;
+};
+
+extern GLStubCounters glStubs;
+
+// Points glad's function pointers at stubs which count their calls instead of reaching a
+// driver, so GL code runs without a context. Uploaded data is copied, as a driver would,
+// and the stub context reports GL 3.3 with no extensions
+void installGLStubs();
+
+#endif
@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "heightmap.h"
+
+#include <iostream>
+#include <vector>
+
+// The layout heightmaps had before Heightmap, filled and read in the same orders the old
+// generateChunk and buildChunkMesh used. Filling walked y outside x, which strides across
+// the inner vectors
+static double legacyPass(unsigned size)
+{
+    std::vector<std::vector<float>> map(size, std::vector<float>(size));
+    for (unsigned y = 0; y < size; y++) {
+        for (unsigned x = 0; x < size; x++) {
+            map[x][y] = x * 0.5f + y;
+        }
+    }
+
+    double sum = 0.0;
+    for (unsigned x = 0; x < size; x++) {
+        for (unsigned z = 0; z < size; z++) {
+            sum += map[x][z];
+        }
+    }
+    return sum;
+}
+
+static double heightmapPass(unsigned size)
+{
+    Heightmap map(size, size);
+    for (unsigned y = 0; y < size; y++) {
+        float* row = map.row(y);
+        for (unsigned x = 0; x < size; x++) {
+            row[x] = x * 0.5f + y;
+        }
+    }
+
+    double sum = 0.0;
+    for (unsigned z = 0; z < size; z++) {
+        const float* row = map.row(z);
+        for (unsigned x = 0; x < size; x++) {
+            sum += row[x];
+        }
+    }
+    return sum;
+}
+
+// Allocates, fills and reads back a square map, once at the old chunk size and once at a
+// size well past the L2 cache
+void benchHeightmap()
+{
+    for (unsigned size : {400u, 2048u}) {
+        double legacy = bestOf(10, [&] { keep(legacyPass(size)); });
+        double flat = bestOf(10, [&] { keep(heightmapPass(size)); });
+
+        std::cout << size << "x" << size << ": vector<vector<float>> " << legacy << " ms, Heightmap " 
+            << flat << " ms (" << legacy / flat << "x)" << std::endl;
+    }
+}
@@ -0,0 +1,39 @@
+#include "bench.h"
+
+#include <cstring>
+#include <iostream>
+
+struct Benchmark
+{
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    {"chunk_mesh", benchChunkMesh},
+    {"chunk_generator", benchChunkGenerator},
+    {"heightmap", benchHeightmap},
+    {"terrain_normals", benchTerrainNormals},
+    {"obj_loader", benchObjLoader},
+    {"vertex_map", benchVertexMap},
+    {"render_queue", benchRenderQueue},
+    {"culling", benchCulling},
+};
+
+// Runs every benchmark, or only those named on the command line
+int main(int argc, char** argv)
+{
+    for (const Benchmark& benchmark : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            selected = selected || std::strcmp(argv[i], benchmark.name) == 0;
+        }
+
+        if (selected) {
+            std::cout << "== " << benchmark.name << std::endl;
+            benchmark.run();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "bench.h"
+#include "mesh/obj_loader.h"
+#include "jobs/thread_pool.h"
+#include "vertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The istringstream loader that Object used before loadObj, less its unused mtllib branch
+static bool legacyLoadObj(const char* modelPath, std::vector<float>& verticies, std::vector<unsigned int>& indices)
+{
+    std::ifstream file(modelPath);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<float> vertexArray;
+    std::vector<float> vertexTexCoordArray;
+    std::vector<float> vertexNormArray;
+
+    std::unordered_map<vertex, unsigned int, LegacyVertexHash> vertexMap;
+    int startIndex = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string prefix;
+        iss >> prefix;
+
+        if (prefix == "v") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            vertexArray.push_back(x);
+            vertexArray.push_back(y);
+            vertexArray.push_back(z);
+        }
+
+        else if (prefix == "vt") {
+            float x, y;
+            iss >> x >> y;
+            vertexTexCoordArray.push_back(x);
+            vertexTexCoordArray.push_back(y);
+        }
+
+        else if (prefix == "vn") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            vertexNormArray.push_back(x);
+            vertexNormArray.push_back(y);
+            vertexNormArray.push_back(z);
+        }
+
+        else if (prefix == "f") {
+            std::vector<int> vertexIndices, textIndices, normIndices;
+            std::string faceVertex;
+
+            while (iss >> faceVertex) {
+                std::replace(faceVertex.begin(), faceVertex.end(), '/', ' ');
+                std::istringstream vertexStream(faceVertex);
+
+                int vertIndex, texIndex, normIndex;
+                if (vertexStream >> vertIndex >> texIndex >> normIndex) {
+                    vertexIndices.push_back(vertIndex);
+                    textIndices.push_back(texIndex);
+                    normIndices.push_back(normIndex);
+                }
+            }
+
+            if (vertexIndices.size() != 3) {
+                return false;
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                vertex vert = vertex(
+                    vertexArray[(vertexIndices[i] - 1) * 3],       vertexArray[(vertexIndices[i] - 1) * 3 + 1],        vertexArray[(vertexIndices[i] - 1) * 3 + 2],
+                    vertexTexCoordArray[(textIndices[i] - 1) * 2], vertexTexCoordArray[(textIndices[i] - 1) * 2 + 1],
+                    vertexNormArray[(normIndices[i] - 1) * 3],     vertexNormArray[(normIndices[i] - 1) * 3 + 1],      vertexNormArray[(normIndices[i] - 1) * 3 + 2]
+                );
+
+                if (vertexMap.find(vert) != vertexMap.end()) {
+                    indices.push_back(vertexMap[vert]);
+                    continue;
+                }
+
+                vertexMap[vert] = startIndex++;
+
+                verticies.push_back(vert.x);
+                verticies.push_back(vert.y);
+                verticies.push_back(vert.z);
+
+                verticies.push_back(vert.u);
+                verticies.push_back(vert.v);
+
+                verticies.push_back(vert.nx);
+                verticies.push_back(vert.ny);
+                verticies.push_back(vert.nz);
+
+                indices.push_back(vertexMap[vert]);
+            }
+        }
+    }
+
+    return true;
+}
+
+// Writes a wavy grid of quads split into triangles, with a texture coordinate and normal
+// per position so every corner refers to all three
+static void writeGridObj(const char* path, unsigned quads)
+{
+    std::ofstream file(path, std::ios::binary);
+    unsigned side = quads + 1;
+    char line[128];
+
+    for (unsigned z = 0; z < side; z++) {
+        for (unsigned x = 0; x < side; x++) {
+            float height = std::sin(x * 0.1f) * std::cos(z * 0.13f);
+            file.write(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x * 0.01f, height, z * 0.01f));
+            file.write(line, std::snprintf(line, sizeof(line), "vt %.6f %.6f\n", (float)x / quads, (float)z / quads));
+            file.write(line, std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", -height * 0.1f, 0.99f, height * 0.05f));
+        }
+    }
+
+    for (unsigned z = 0; z < quads; z++) {
+        for (unsigned x = 0; x < quads; x++) {
+            unsigned a = z * side + x + 1;
+            unsigned b = a + 1;
+            unsigned c = a + side;
+            unsigned d = c + 1;
+            file.write(line, std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, b, b, b));
+            file.write(line, std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", b, b, b, c, c, c, d, d, d));
+        }
+    }
+}
+
+// Loads a generated model of about a million triangles with each loader
+void benchObjLoader()
+{
+    const char* path = "bench_model.obj";
+    writeGridObj(path, 708);
+
+    std::vector<float> legacyVertices;
+    std::vector<unsigned int> legacyIndices;
+    double legacy = bestOf(1, [&] {
+        legacyVertices.clear();
+        legacyIndices.clear();
+        legacyLoadObj(path, legacyVertices, legacyIndices);
+    });
+
+    MeshData mesh;
+    double mapped = bestOf(3, [&] { loadObj(path, mesh); });
+
+    ThreadPool pool;
+    MeshData pooledMesh;
+    double pooled = bestOf(3, [&] { loadObj(path, pooledMesh, &pool); });
+
+    std::remove(path);
+
+    bool same = mesh.vertices == legacyVertices && mesh.indices == legacyIndices
+        && pooledMesh.vertices == mesh.vertices && pooledMesh.indices == mesh.indices;
+
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertexCount() << " vertices, output " 
+        << (same ? "identical" : "DIFFERS") << std::endl;
+    std::cout << "istringstream loader " << legacy << " ms, loadObj " << mapped << " ms (" << legacy / mapped 
+        << "x), loadObj with " << pool.size() << " worker" << (pool.size() == 1 ? " " : "s ") << pooled << " ms" << std::endl;
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "heightmap.h"
+#include "terrain_normals.h"
+#include "maths/maths.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// The three passes buildChunkMesh made before computeTerrainNormals: write interleaved
+// position and normal vertices, add both triangle normals of every cell to its corners,
+// then renormalise every vertex
+static void legacyNormals(const HeightmapView& heights, std::vector<float>& vertices)
+{
+    int x_width = heights.getWidth();
+    int z_width = heights.getHeight();
+    vertices.assign(x_width * z_width * 6, 0.0f);
+
+    for (int z = 0; z < z_width; z++) {
+        const float* row = heights.row(z);
+        for (int x = 0; x < x_width; x++) {
+            int pos = 6 * (z * x_width + x);
+            vertices[pos] = x;
+            vertices[pos+1] = row[x];
+            vertices[pos+2] = z;
+        }
+    }
+
+    for (int z = 0; z < z_width - 1; z++) {
+        for (int x = 0; x < x_width - 1; x++) {
+            int top_left_pos = 6 * (z * x_width + x);
+            int top_right_pos = 6 * ((z+1) * x_width + x);
+            int bottom_left_pos = 6 * (z * x_width + x + 1);
+            int bottom_right_pos = 6 * ((z+1) * x_width + x + 1);
+
+            vec3 top_left = vec3(vertices[top_left_pos], vertices[top_left_pos + 1], vertices[top_left_pos + 2]);
+            vec3 top_right = vec3(vertices[top_right_pos], vertices[top_right_pos + 1], vertices[top_right_pos + 2]);
+            vec3 bottom_left = vec3(vertices[bottom_left_pos], vertices[bottom_left_pos + 1], vertices[bottom_left_pos + 2]);
+            vec3 bottom_right = vec3(vertices[bottom_right_pos], vertices[bottom_right_pos + 1], vertices[bottom_right_pos + 2]);
+
+            vec3 top_triangle_normal = (top_right - top_left).cross(bottom_left - top_left).normalize();
+            vec3 bottom_triangle_normal = (bottom_left - bottom_right).cross(top_right - bottom_right).normalize();
+
+            vertices[top_left_pos + 3] += top_triangle_normal.x;
+            vertices[top_left_pos + 4] += top_triangle_normal.y;
+            vertices[top_left_pos + 5] += top_triangle_normal.z;
+
+            vertices[top_right_pos + 3] += top_triangle_normal.x + bottom_triangle_normal.x;
+            vertices[top_right_pos + 4] += top_triangle_normal.y + bottom_triangle_normal.y;
+            vertices[top_right_pos + 5] += top_triangle_normal.z + bottom_triangle_normal.z;
+
+            vertices[bottom_left_pos + 3] += top_triangle_normal.x + bottom_triangle_normal.x;
+            vertices[bottom_left_pos + 4] += top_triangle_normal.y + bottom_triangle_normal.y;
+            vertices[bottom_left_pos + 5] += top_triangle_normal.z + bottom_triangle_normal.z;
+
+            vertices[bottom_right_pos + 3] += bottom_triangle_normal.x;
+            vertices[bottom_right_pos + 4] += bottom_triangle_normal.y;
+            vertices[bottom_right_pos + 5] += bottom_triangle_normal.z;
+        }
+    }
+
+    for (int i = 0; i < x_width * z_width; i++) {
+        int pos = 6 * i;
+        vec3 normal = vec3(vertices[pos+3], vertices[pos+4], vertices[pos+5]).normalize();
+        vertices[pos+3] = normal.x;
+        vertices[pos+4] = normal.y;
+        vertices[pos+5] = normal.z;
+    }
+}
+
+// Normals for a chunk with its apron, and for a map wide enough to need the column tiles
+void benchTerrainNormals()
+{
+    for (unsigned size : {131u, 2050u}) {
+        Heightmap heights(size, size);
+        for (unsigned z = 0; z < size; z++) {
+            for (unsigned x = 0; x < size; x++) {
+                heights.at(x, z) = 20.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+            }
+        }
+
+        unsigned inner = size - 2;
+        std::vector<float> normals(inner * inner * 3);
+        std::vector<float> vertices;
+        unsigned runs = size < 1000 ? 50 : 5;
+
+        double legacy = bestOf(runs, [&] {
+            legacyNormals(heights.view(), vertices);
+            keep(vertices[4]);
+        });
+        double onePass = bestOf(runs, [&] {
+            computeTerrainNormals(heights.view(), 1.0f, normals.data(), normals.data() + inner * inner, 
+                normals.data() + 2 * inner * inner);
+            keep(normals[0]);
+        });
+
+        std::cout << size << "x" << size << ": three pass " << legacy << " ms, one pass " << onePass 
+            << " ms (" << legacy / onePass << "x)" << std::endl;
+    }
+}
@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "mesh/vertex_map.h"
+#include "vertex.h"
+
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Old loader's pattern, a find followed by one or two operator[] lookups
+template <typename Map>
+static unsigned dedupFindThenInsert(const std::vector<vertex>& corners, std::vector<unsigned int>& indices)
+{
+    Map map;
+    unsigned next = 0;
+    for (size_t i = 0; i < corners.size(); i++) {
+        if (map.find(corners[i]) != map.end()) {
+            indices[i] = map[corners[i]];
+            continue;
+        }
+        map[corners[i]] = next++;
+        indices[i] = map[corners[i]];
+    }
+    return next;
+}
+
+// Corners of a grid of triangles, in the order an OBJ exporter writes them, so each
+// vertex is looked up by up to six corners. Neighbouring vertices differ only slightly
+static std::vector<vertex> gridCorners(unsigned quads)
+{
+    unsigned side = quads + 1;
+    std::vector<vertex> grid;
+    grid.reserve(side * side);
+    for (unsigned z = 0; z < side; z++) {
+        for (unsigned x = 0; x < side; x++) {
+            float height = std::sin(x * 0.1f) * std::cos(z * 0.13f);
+            grid.emplace_back(x * 0.01f, height, z * 0.01f, (float)x / quads, (float)z / quads, 
+                -height * 0.1f, 0.99f, height * 0.05f);
+        }
+    }
+
+    std::vector<vertex> corners;
+    corners.reserve(quads * quads * 6);
+    for (unsigned z = 0; z < quads; z++) {
+        for (unsigned x = 0; x < quads; x++) {
+            unsigned a = z * side + x;
+            unsigned b = a + 1;
+            unsigned c = a + side;
+            unsigned d = c + 1;
+            for (unsigned corner : {a, c, b, b, c, d}) {
+                corners.push_back(grid[corner]);
+            }
+        }
+    }
+    return corners;
+}
+
+// Deduplicates about 6M corners down to 1M unique vertices with each map
+void benchVertexMap()
+{
+    std::vector<vertex> corners = gridCorners(1000);
+    std::vector<unsigned int> indices(corners.size());
+    std::vector<unsigned int> expected(corners.size());
+
+    unsigned unique = 0;
+    double flat = bestOf(3, [&] {
+        VertexMap map;
+        map.reserve(1001 * 1001);
+        for (size_t i = 0; i < corners.size(); i++) {
+            expected[i] = map.insertOrGet(corners[i]);
+        }
+        unique = map.size();
+    });
+
+    double newHash = bestOf(1, [&] {
+        dedupFindThenInsert<std::unordered_map<vertex, unsigned int>>(corners, indices);
+    });
+    bool same = indices == expected;
+
+    double oldHash = bestOf(1, [&] {
+        dedupFindThenInsert<std::unordered_map<vertex, unsigned int, LegacyVertexHash>>(corners, indices);
+    });
+    same = same && indices == expected;
+
+    std::cout << corners.size() << " corners, " << unique << " unique, indices " 
+        << (same ? "identical" : "DIFFER") << std::endl;
+    std::cout << "VertexMap " << flat << " ms, unordered_map with hashVertex " << newHash 
+        << " ms, unordered_map with the old hash " << oldHash << " ms" << std::endl;
+}
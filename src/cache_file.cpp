@@ -0,0 +1,45 @@
+#include "cache_file.h"
+
+#include <filesystem>
+#include <fstream>
+
+bool readSourceInfo(const char* path, uint64_t& size, int64_t& time)
+{
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+
+    size = fileSize;
+    time = (int64_t)writeTime.time_since_epoch().count();
+    return true;
+}
+
+bool writeFileAtomically(const std::string& path, std::initializer_list<FileChunk> chunks)
+{
+    std::string temporaryPath = path + ".tmp";
+    std::error_code error;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        for (const FileChunk& chunk : chunks) {
+            file.write((const char*)chunk.data, chunk.size);
+        }
+        if (!file) {
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
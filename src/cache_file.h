@@ -0,0 +1,24 @@
+#ifndef CACHE_FILE_H
+#define CACHE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+// Helpers shared by the mesh, texture and shader program caches
+
+// Size and modification time of the file a cache was built from, failing if it is missing
+bool readSourceInfo(const char* path, uint64_t& size, int64_t& time);
+
+struct FileChunk
+{
+    const void* data;
+    size_t size;
+};
+
+// Writes the chunks one after another under a temporary name, then renames the result into
+// place, so an interrupted write never leaves a truncated cache behind
+bool writeFileAtomically(const std::string& path, std::initializer_list<FileChunk> chunks);
+
+#endif
@@ -11,6 +11,7 @@ class Camera
 
         mat4 getView() const { return view; }
         mat4 getProjection() const { return projection; }
+        frustum getFrustum() const { return frustum::fromMatrix(projection * view); }
 
         vec3 getPosition() const { return position; }
         vec3 getFront() const { return front; }
@@ -21,6 +22,7 @@ class Camera
         float getDirectionSpeed() const { return directionSpeed; }
 
         void setPosition(vec3 position) { this->position = position; }
+        void setProjection(mat4 projection) { this->projection = projection; }
         void incPosition(vec3 position);
 
     private:
@@ -0,0 +1,49 @@
+#include "chunk_generator.h"
+
+ChunkGenerator::ChunkGenerator(const World& world, unsigned numThreads)
+    :world(world), inFlight(0), pool(numThreads)
+{
+
+}
+
+void ChunkGenerator::request(ChunkCoord coord, std::shared_ptr<std::atomic<bool>> cancelled)
+{
+    inFlight.fetch_add(1, std::memory_order_relaxed);
+
+    pool.submit([this, coord, cancelled] {
+        GeneratedChunk chunk;
+        chunk.coord = coord;
+        chunk.cancelled = cancelled;
+
+        // Cancelled chunks still complete, just with an empty mesh
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            completed.push(std::move(chunk));
+            return;
+        }
+
+        Heightmap heightmap = world.generateChunk(coord.x, coord.y);
+        world.buildChunkMesh(heightmap.view(), chunk.mesh);
+        chunk.mesh.origin = world.getChunkOrigin(coord.x, coord.y);
+
+        completed.push(std::move(chunk));
+    });
+}
+
+unsigned ChunkGenerator::drain(unsigned maxChunks, std::vector<GeneratedChunk>& finished)
+{
+    unsigned count = 0;
+    GeneratedChunk chunk;
+
+    while (count < maxChunks && completed.pop(chunk)) {
+        inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+        if (chunk.cancelled && chunk.cancelled->load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        finished.push_back(std::move(chunk));
+        count++;
+    }
+
+    return count;
+}
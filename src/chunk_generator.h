@@ -0,0 +1,46 @@
+#ifndef CHUNK_GENERATOR_H
+#define CHUNK_GENERATOR_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "world.h"
+#include "chunk_mesh.h"
+#include "jobs/thread_pool.h"
+#include "jobs/mpsc_queue.h"
+
+struct GeneratedChunk
+{
+    ChunkCoord coord;
+    ChunkMesh mesh;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+class ChunkGenerator
+{
+    public:
+        ChunkGenerator(const World& world, unsigned numThreads = 0);
+
+        // Queues a chunk for generation on the worker threads. Once the optional
+        // cancelled flag is set the chunk is skipped or dropped instead of uploaded
+        void request(ChunkCoord coord, std::shared_ptr<std::atomic<bool>> cancelled = nullptr);
+
+        // Takes at most maxChunks finished chunks off the completion queue. Only one thread
+        // may drain, normally the render thread, which then uploads the meshes
+        unsigned drain(unsigned maxChunks, std::vector<GeneratedChunk>& finished);
+
+        unsigned pending() const { return inFlight.load(std::memory_order_relaxed); }
+        unsigned numThreads() const { return pool.size(); }
+
+    private:
+        const World& world;
+
+        // Declared before the pool so that it outlives any running worker
+        MPSCQueue<GeneratedChunk> completed;
+        std::atomic<unsigned> inFlight;
+
+        ThreadPool pool;
+};
+
+#endif
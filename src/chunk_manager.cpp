@@ -0,0 +1,215 @@
+#include "chunk_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Coarsest level of detail still keeps this many cells along each chunk edge
+static const unsigned minLodCells = 8;
+
+ChunkManager::ChunkManager(const World& world, int loadRadius, int unloadRadius, unsigned maxUploadsPerFrame, float lodDistance)
+    :world(world), generator(world), loadRadius(loadRadius), unloadRadius(std::max(loadRadius, unloadRadius)),
+    terrainBuffers((2 * this->unloadRadius + 1) * (2 * this->unloadRadius + 1) * (world.getChunkWidth() + 1) * (world.getChunkWidth() + 1)),
+    indexBuffers((world.getChunkWidth() + 1) * (world.getChunkWidth() + 1)),
+    maxUploadsPerFrame(maxUploadsPerFrame), lodDistance(lodDistance), maxLod(0)
+{
+    // Every level's step, and the step of the level above it for stitching, has to divide the chunk width
+    unsigned cells = world.getChunkWidth();
+    while (cells % 2 == 0 && cells / 2 >= minLodCells) {
+        cells /= 2;
+        maxLod++;
+    }
+}
+
+void ChunkManager::update(const vec3& cameraPosition)
+{
+    ChunkCoord centre = toChunkCoord(cameraPosition);
+
+    // Evicts resident chunks and cancels requests which left the unload ring
+    for (auto it = resident.begin(); it != resident.end();) {
+        if (withinRadius(it->first, centre, unloadRadius)) {
+            ++it;
+            continue;
+        }
+
+        it->second.mesh.release(terrainBuffers);
+        it = resident.erase(it);
+        stats.evictions++;
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (withinRadius(it->first, centre, unloadRadius)) {
+            ++it;
+            continue;
+        }
+
+        it->second->store(true, std::memory_order_relaxed);
+        it = pending.erase(it);
+    }
+
+    // Requests missing chunks inside the load ring, nearest first
+    std::vector<ChunkCoord> missing;
+    for (int y = centre.y - loadRadius; y <= centre.y + loadRadius; y++) {
+        for (int x = centre.x - loadRadius; x <= centre.x + loadRadius; x++) {
+            ChunkCoord coord = {x, y};
+            if (withinRadius(coord, centre, loadRadius) && !resident.count(coord) && !pending.count(coord)) {
+                missing.push_back(coord);
+            }
+        }
+    }
+
+    std::sort(missing.begin(), missing.end(), [centre](ChunkCoord a, ChunkCoord b) {
+        int da = (a.x - centre.x) * (a.x - centre.x) + (a.y - centre.y) * (a.y - centre.y);
+        int db = (b.x - centre.x) * (b.x - centre.x) + (b.y - centre.y) * (b.y - centre.y);
+        return da < db;
+    });
+
+    for (ChunkCoord coord : missing) {
+        std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+        pending[coord] = cancelled;
+        generator.request(coord, cancelled);
+    }
+
+    finished.clear();
+    generator.drain(maxUploadsPerFrame, finished);
+
+    for (GeneratedChunk& chunk : finished) {
+        chunk.mesh.upload(terrainBuffers);
+
+        pending.erase(chunk.coord);
+        resident[chunk.coord].mesh = std::move(chunk.mesh);
+    }
+
+    selectLevelsOfDetail(cameraPosition);
+
+    stats.resident = resident.size();
+    stats.pending = pending.size();
+}
+
+void ChunkManager::selectLevelsOfDetail(const vec3& cameraPosition)
+{
+    const float width = world.getChunkWidth();
+
+    for (auto& chunk : resident) {
+        // Distance in x/z from the camera to the nearest point of the chunk
+        vec3 origin = chunk.second.mesh.origin;
+        float dx = std::max({origin.x - cameraPosition.x, 0.0f, cameraPosition.x - (origin.x + width)});
+        float dz = std::max({origin.z - cameraPosition.z, 0.0f, cameraPosition.z - (origin.z + width)});
+        float distance = std::sqrt(dx * dx + dz * dz);
+
+        unsigned lod = 0;
+        while (lod < maxLod && distance >= lodDistance * (1u << lod)) {
+            lod++;
+        }
+        chunk.second.lod = lod;
+    }
+
+    // Neighbours may only differ by one level, so lower any chunk much coarser than
+    // a neighbour until that holds everywhere
+    const ChunkCoord offsets[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto& chunk : resident) {
+            for (ChunkCoord offset : offsets) {
+                auto neighbour = resident.find({chunk.first.x + offset.x, chunk.first.y + offset.y});
+                if (neighbour != resident.end() && chunk.second.lod > neighbour->second.lod + 1) {
+                    chunk.second.lod = neighbour->second.lod + 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // The offsets are in the same order as the stitch edge bits
+    for (auto& chunk : resident) {
+        chunk.second.stitchMask = 0;
+        for (unsigned edge = 0; edge < 4; edge++) {
+            auto neighbour = resident.find({chunk.first.x + offsets[edge].x, chunk.first.y + offsets[edge].y});
+            if (neighbour != resident.end() && neighbour->second.lod > chunk.second.lod) {
+                chunk.second.stitchMask |= 1u << edge;
+            }
+        }
+    }
+}
+
+void ChunkManager::draw(RenderQueue& queue, Shader& shader, const frustum& view, FrameStats& frameStats)
+{
+    stats.triangles = 0;
+    terrainBuffers.clearDraws();
+
+    drawList.clear();
+    drawBounds.clear();
+    for (const auto& chunk : resident) {
+        drawList.push_back(&chunk.second);
+        drawBounds.add(chunk.second.mesh.bounds.translated(chunk.second.mesh.origin));
+    }
+
+    drawBounds.cull(view, visible);
+
+    for (unsigned i = 0; i < drawList.size(); i++) {
+        if (!visible[i]) {
+            frameStats.culled++;
+            continue;
+        }
+
+        const ResidentChunk& chunk = *drawList[i];
+        const ChunkMesh& mesh = chunk.mesh;
+        const TerrainIndexRange& indices = indexBuffers.get(mesh.width, mesh.height, 1u << chunk.lod, chunk.stitchMask);
+
+        terrainBuffers.addDraw(mesh.origin, mesh.width, mesh.getFirstVertex(), indices);
+        stats.triangles += indices.count / 3;
+        frameStats.drawn++;
+    }
+
+    if (terrainBuffers.numDraws() == 0) {
+        stats.drawCalls = 0;
+        return;
+    }
+
+    // Fetched after every get above, which may have replaced the element buffer
+    DrawItem item;
+    item.program = shader.ID;
+    item.VAO = terrainBuffers.getVAO();
+    item.EBO = indexBuffers.getEBO();
+    item.draw = drawVisible;
+    item.drawData = this;
+
+    queue.submit(item, RENDER_PASS_OPAQUE, 0.0f);
+}
+
+void ChunkManager::drawVisible(void* manager)
+{
+    ChunkManager& chunks = *(ChunkManager*)manager;
+    chunks.terrainBuffers.draw(chunks.indexBuffers.getType(), chunks.indexBuffers.getIndexSize());
+    chunks.stats.drawCalls = chunks.terrainBuffers.drawCalls();
+    chunks.stats.multiDrawIndirect = chunks.terrainBuffers.usesMultiDrawIndirect();
+}
+
+void ChunkManager::release()
+{
+    for (auto& chunk : resident) {
+        chunk.second.mesh.release(terrainBuffers);
+    }
+    resident.clear();
+
+    for (auto& request : pending) {
+        request.second->store(true, std::memory_order_relaxed);
+    }
+    pending.clear();
+
+    indexBuffers.release();
+    terrainBuffers.release();
+}
+
+ChunkCoord ChunkManager::toChunkCoord(const vec3& position) const
+{
+    float width = world.getChunkWidth();
+    return {(int)std::floor(position.x / width), (int)std::floor(position.z / width)};
+}
+
+bool ChunkManager::withinRadius(ChunkCoord coord, ChunkCoord centre, int radius) const
+{
+    int dx = coord.x - centre.x;
+    int dy = coord.y - centre.y;
+    return dx * dx + dy * dy <= radius * radius;
+}
@@ -0,0 +1,89 @@
+#ifndef CHUNK_MANAGER_H
+#define CHUNK_MANAGER_H
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "world.h"
+#include "chunk_mesh.h"
+#include "chunk_generator.h"
+#include "terrain_indices.h"
+#include "terrain_buffers.h"
+#include "culling.h"
+#include "render_queue.h"
+#include "shaders/shader.h"
+
+struct ChunkStats
+{
+    unsigned resident = 0;
+    unsigned pending = 0;
+    unsigned evictions = 0;
+    // Terrain triangles submitted by the last draw
+    unsigned triangles = 0;
+    // GL draw calls the last draw took
+    unsigned drawCalls = 0;
+    // Whether the last draw went through glMultiDrawElementsIndirect
+    bool multiDrawIndirect = false;
+};
+
+class ChunkManager
+{
+    public:
+        // Chunks within loadRadius of the camera chunk are generated and kept until they
+        // are further than unloadRadius away, the gap between the two avoids thrashing.
+        // Chunks closer than lodDistance are drawn at full detail, and each doubling of
+        // the distance past that halves the detail
+        ChunkManager(const World& world, int loadRadius, int unloadRadius, unsigned maxUploadsPerFrame, float lodDistance);
+
+        void update(const vec3& cameraPosition);
+        // Queues the resident chunks inside the view frustum as a single item, which draws
+        // them all with one multi-draw, or one call per chunk where that is unsupported
+        void draw(RenderQueue& queue, Shader& shader, const frustum& view, FrameStats& frameStats);
+        void release();
+
+        const ChunkStats& getStats() const { return stats; }
+
+    private:
+        struct ResidentChunk
+        {
+            ChunkMesh mesh;
+            unsigned lod = 0;
+            unsigned stitchMask = 0;
+        };
+
+        void selectLevelsOfDetail(const vec3& cameraPosition);
+        // Render queue callback, given the manager
+        static void drawVisible(void* manager);
+
+        ChunkCoord toChunkCoord(const vec3& position) const;
+        bool withinRadius(ChunkCoord coord, ChunkCoord centre, int radius) const;
+
+        const World& world;
+        ChunkGenerator generator;
+
+        // Declared before the buffers, which are sized from the clamped unload radius
+        int loadRadius;
+        int unloadRadius;
+
+        TerrainBuffers terrainBuffers;
+        TerrainIndexBuffers indexBuffers;
+
+        unsigned maxUploadsPerFrame;
+        float lodDistance;
+        unsigned maxLod;
+
+        std::unordered_map<ChunkCoord, ResidentChunk> resident;
+        std::unordered_map<ChunkCoord, std::shared_ptr<std::atomic<bool>>> pending;
+        std::vector<GeneratedChunk> finished;
+
+        // Reused every frame for culling
+        std::vector<const ResidentChunk*> drawList;
+        BoundsBatch drawBounds;
+        std::vector<unsigned char> visible;
+
+        ChunkStats stats;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#include "chunk_mesh.h"
+#include "terrain_buffers.h"
+
+void ChunkMesh::upload(TerrainBuffers& buffers)
+{
+    firstVertex = buffers.allocate(vertices);
+
+    // The GPU owns the mesh from here on, so the CPU copy is no longer needed
+    std::vector<TerrainVertex>().swap(vertices);
+}
+
+void ChunkMesh::release(TerrainBuffers& buffers)
+{
+    if (firstVertex >= 0) {
+        buffers.free(firstVertex, width * height);
+    }
+    firstVertex = -1;
+}
\ No newline at end of file
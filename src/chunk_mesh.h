@@ -0,0 +1,34 @@
+#ifndef CHUNK_MESH_H
+#define CHUNK_MESH_H
+
+#include <vector>
+
+#include "maths/maths.h"
+#include "terrain_vertex.h"
+
+class TerrainBuffers;
+
+class ChunkMesh
+{
+    public:
+        // Copies the CPU-side vertices into the shared terrain buffer and frees them
+        void upload(TerrainBuffers& buffers);
+        void release(TerrainBuffers& buffers);
+
+        // Position of the chunk's first vertex in the shared buffer
+        unsigned getFirstVertex() const { return firstVertex; }
+
+        std::vector<TerrainVertex> vertices;
+        // Vertices along x and z, laid out row-major
+        unsigned width = 0;
+        unsigned height = 0;
+
+        vec3 origin;
+        // Bounds relative to the origin
+        aabb bounds;
+
+    private:
+        int firstVertex = -1;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "culling.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CULLING_SSE 1
+    #include <emmintrin.h>
+#else
+    #define CULLING_SSE 0
+#endif
+
+void BoundsBatch::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+void BoundsBatch::add(const aabb& box)
+{
+    vec3 c = box.center();
+    vec3 e = box.extents();
+
+    centerX.push_back(c.x);
+    centerY.push_back(c.y);
+    centerZ.push_back(c.z);
+    extentX.push_back(e.x);
+    extentY.push_back(e.y);
+    extentZ.push_back(e.z);
+}
+
+void BoundsBatch::cull(const frustum& view, std::vector<unsigned char>& visible) const
+{
+    const unsigned count = size();
+    visible.resize(count);
+
+    unsigned i = 0;
+
+#if CULLING_SSE
+    // Four boxes against one plane at a time, a box is outside once any plane rejects it
+    __m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++) {
+        px[p] = _mm_set1_ps(view.planes[p].x);
+        py[p] = _mm_set1_ps(view.planes[p].y);
+        pz[p] = _mm_set1_ps(view.planes[p].z);
+        pw[p] = _mm_set1_ps(view.planes[p].w);
+        ax[p] = _mm_set1_ps(std::fabs(view.planes[p].x));
+        ay[p] = _mm_set1_ps(std::fabs(view.planes[p].y));
+        az[p] = _mm_set1_ps(std::fabs(view.planes[p].z));
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(&centerX[i]);
+        __m128 cy = _mm_loadu_ps(&centerY[i]);
+        __m128 cz = _mm_loadu_ps(&centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&extentX[i]);
+        __m128 ey = _mm_loadu_ps(&extentY[i]);
+        __m128 ez = _mm_loadu_ps(&extentZ[i]);
+
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        visible[i] = !(mask & 1);
+        visible[i + 1] = !(mask & 2);
+        visible[i + 2] = !(mask & 4);
+        visible[i + 3] = !(mask & 8);
+    }
+#endif
+
+    for (; i < count; i++) {
+        aabb box(
+            vec3(centerX[i] - extentX[i], centerY[i] - extentY[i], centerZ[i] - extentZ[i]),
+            vec3(centerX[i] + extentX[i], centerY[i] + extentY[i], centerZ[i] + extentZ[i])
+        );
+        visible[i] = view.intersects(box);
+    }
+}
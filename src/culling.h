@@ -0,0 +1,33 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <vector>
+
+#include "maths/maths.h"
+
+struct FrameStats
+{
+    unsigned drawn = 0;
+    unsigned culled = 0;
+};
+
+// Boxes stored as separate arrays of centres and extents, so several can be tested
+// against a plane with one SIMD instruction
+class BoundsBatch
+{
+    public:
+        void clear();
+        void add(const aabb& box);
+
+        unsigned size() const { return centerX.size(); }
+        vec3 center(unsigned i) const { return vec3(centerX[i], centerY[i], centerZ[i]); }
+
+        // Sets visible[i] to 1 for every box which touches the frustum and 0 otherwise
+        void cull(const frustum& view, std::vector<unsigned char>& visible) const;
+
+    private:
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ;
+};
+
+#endif
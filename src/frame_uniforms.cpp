@@ -0,0 +1,25 @@
+#include "frame_uniforms.h"
+
+#include <glad/glad.h>
+
+void FrameUniforms::update(const FrameData& data)
+{
+    if (!UBO) {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, frameDataBinding, UBO);
+    }
+    else {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    }
+
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::release()
+{
+    glDeleteBuffers(1, &UBO);
+    UBO = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include "maths/maths.h"
+
+// Uniform buffer binding point of the FrameData block
+constexpr unsigned int frameDataBinding = 0;
+
+// Per-frame data shared by every shader program, laid out to match the std140 FrameData
+// block. The block is declared row_major, so matrices are copied as they are
+struct FrameData
+{
+    mat4 view;
+    mat4 projection;
+    // xyz used, w is std140 padding
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+static_assert(sizeof(FrameData) == 160, "FrameData must match the std140 block layout");
+
+// Owns the uniform buffer behind the FrameData block. Shaders only need their block bound
+// to frameDataBinding once, after which a single buffer write per frame reaches all of them
+class FrameUniforms
+{
+    public:
+        // Creates the buffer on first use. Must be called on the render thread
+        void update(const FrameData& data);
+        void release();
+
+    private:
+        unsigned int UBO = 0;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+// Capability checks for features beyond the GL 3.3 core loader. Need a current context
+
+bool hasGLExtension(const char* name);
+// True if the context is at least the given version
+bool hasGLVersion(int major, int minor);
+
+#endif
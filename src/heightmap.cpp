@@ -0,0 +1,48 @@
+#include "heightmap.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+Heightmap::Heightmap()
+    :data(nullptr), width(0), height(0), stride(0)
+{
+
+}
+
+Heightmap::Heightmap(unsigned width, unsigned height)
+    :width(width), height(height)
+{
+    const size_t floatsPerLine = alignment / sizeof(float);
+    stride = (width + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+
+    size_t bytes = stride * height * sizeof(float);
+    data = static_cast<float*>(::operator new[](bytes, std::align_val_t(alignment)));
+    std::memset(data, 0, bytes);
+}
+
+Heightmap::~Heightmap()
+{
+    if (data) {
+        ::operator delete[](data, std::align_val_t(alignment));
+    }
+}
+
+Heightmap::Heightmap(Heightmap&& other) noexcept
+    :data(other.data), width(other.width), height(other.height), stride(other.stride)
+{
+    other.data = nullptr;
+    other.width = other.height = 0;
+    other.stride = 0;
+}
+
+Heightmap& Heightmap::operator=(Heightmap&& other) noexcept
+{
+    if (this != &other) {
+        std::swap(data, other.data);
+        std::swap(width, other.width);
+        std::swap(height, other.height);
+        std::swap(stride, other.stride);
+    }
+    return *this;
+}
@@ -0,0 +1,70 @@
+#ifndef HEIGHTMAP_H
+#define HEIGHTMAP_H
+
+#include <cstddef>
+
+// Read-only window onto row-major height samples, x runs along a row and y between rows
+class HeightmapView
+{
+    public:
+        HeightmapView(const float* data, unsigned width, unsigned height, size_t stride)
+            : data(data), width(width), height(height), stride(stride)
+        {
+        }
+
+        unsigned getWidth() const { return width; }
+        unsigned getHeight() const { return height; }
+        size_t getStride() const { return stride; }
+
+        const float* row(unsigned y) const { return data + y * stride; }
+        float at(unsigned x, unsigned y) const { return data[y * stride + x]; }
+
+        HeightmapView subview(unsigned x, unsigned y, unsigned w, unsigned h) const
+        {
+            return HeightmapView(data + y * stride + x, w, h, stride);
+        }
+
+    private:
+        const float* data;
+        unsigned width;
+        unsigned height;
+        size_t stride;
+};
+
+// Owns a grid of height samples in one cache line aligned allocation. Each row is
+// padded to a whole number of cache lines so rows also start aligned
+class Heightmap
+{
+    public:
+        static constexpr size_t alignment = 64;
+
+        Heightmap();
+        Heightmap(unsigned width, unsigned height);
+        ~Heightmap();
+
+        Heightmap(Heightmap&& other) noexcept;
+        Heightmap& operator=(Heightmap&& other) noexcept;
+
+        Heightmap(const Heightmap&) = delete;
+        Heightmap& operator=(const Heightmap&) = delete;
+
+        unsigned getWidth() const { return width; }
+        unsigned getHeight() const { return height; }
+        size_t getStride() const { return stride; }
+
+        float* row(unsigned y) { return data + y * stride; }
+        const float* row(unsigned y) const { return data + y * stride; }
+
+        float& at(unsigned x, unsigned y) { return data[y * stride + x]; }
+        float at(unsigned x, unsigned y) const { return data[y * stride + x]; }
+
+        HeightmapView view() const { return HeightmapView(data, width, height, stride); }
+
+    private:
+        float* data;
+        unsigned width;
+        unsigned height;
+        size_t stride;
+};
+
+#endif
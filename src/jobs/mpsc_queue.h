@@ -0,0 +1,66 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Lock-free multi-producer single-consumer queue (Vyukov style linked list).
+// Any thread may push, but only one thread may pop.
+template <typename T>
+class MPSCQueue
+{
+    public:
+        MPSCQueue()
+        {
+            Node* stub = new Node();
+            head.store(stub, std::memory_order_relaxed);
+            tail = stub;
+        }
+
+        ~MPSCQueue()
+        {
+            while (tail) {
+                Node* next = tail->next.load(std::memory_order_relaxed);
+                delete tail;
+                tail = next;
+            }
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        void push(T value)
+        {
+            Node* node = new Node();
+            node->value = std::move(value);
+
+            Node* prev = head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        bool pop(T& value)
+        {
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next) {
+                return false;
+            }
+
+            // The popped node becomes the new stub
+            value = std::move(next->value);
+            delete tail;
+            tail = next;
+            return true;
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next{nullptr};
+            T value;
+        };
+
+        std::atomic<Node*> head;
+        Node* tail;
+};
+
+#endif
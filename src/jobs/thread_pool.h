@@ -0,0 +1,41 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+    public:
+        // A thread count of 0 uses one worker per hardware thread, leaving one for rendering
+        explicit ThreadPool(unsigned numThreads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> job);
+        // Blocks until every submitted job has finished
+        void wait();
+
+        unsigned size() const { return workers.size(); }
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> jobs;
+
+        std::mutex mutex;
+        std::condition_variable jobAvailable;
+        std::condition_variable jobsFinished;
+
+        unsigned activeJobs;
+        bool stopping;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <memory>
 
 #include "shaders/shader.h"
 #include "dependencies/stb_image.h"
@@ -9,6 +10,11 @@
 #include "object.h"
 #include "camera.h"
 #include "world.h"
+#include "chunk_manager.h"
+#include "texture_manager.h"
+#include "frame_uniforms.h"
+#include "render_queue.h"
+#include "noise/gradient_noise.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window, float deltaTime, Camera& camera);
@@ -51,21 +57,54 @@ int main() {
     Shader shader("src/shaders/vertexShader.glsl", "src/shaders/fragmentShader.glsl");
     Shader Worldshader("src/shaders/worldVertexShader.glsl", "src/shaders/worldFragmentShader.glsl");
 
-    shader.use();
+    // Camera and lighting reach every program through one uniform buffer
+    shader.bindUniformBlock("FrameData", frameDataBinding);
+    Worldshader.bindUniformBlock("FrameData", frameDataBinding);
+    FrameUniforms frameUniforms;
+
     mat4 projection = mat4::projection(45.0f, (float)width / (float)height, 0.1f, 10000.0f);
-    int projectionLoc = glGetUniformLocation(shader.ID, "projection");
-    glUniformMatrix4fv(projectionLoc, 1, GL_TRUE, projection.m);
+
+    FrameData frameData;
+    frameData.projection = projection;
+    frameData.lightPos = vec4(500.0f, 70.0f, 100.0f, 1.0f);
+    frameData.lightColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
     Worldshader.use();
-    projectionLoc = glGetUniformLocation(Worldshader.ID, "projection");
-    glUniformMatrix4fv(projectionLoc, 1, GL_TRUE, projection.m);
+    Worldshader.setVec3("objectColor", vec3(0.0f, 1.0f, 0.0f));
+    shader.use();
+    shader.setInt("texture1", 0);
+
+    // Two decode threads, uploading at most 8 MB of pixels a frame
+    TextureManager textures(2);
 
-    Object tree = Object(shader, "models/Tree1/Tree1.obj");
+    // Models are parsed across every core, the pool is only kept while they load
+    std::unique_ptr<ThreadPool> loaderPool = std::make_unique<ThreadPool>();
+    Object tree = Object(shader, "models/Tree1/Tree1.obj", textures.load("models/Tree1/baked.png"), loaderPool.get());
+    loaderPool.reset();
 
     Camera camera = Camera(vec3(0.0f, -5.0f, -10.0f), vec3(0.0f, 0.0f, -1.0f), 45.0f, 10.0f, 100.0f);
+    camera.setProjection(projection);
+
+    World world = World(0, 64, 2, 32);
+    Worldshader.use();
+    world.setTerrainUniforms(Worldshader);
+    std::cout << "Noise kernel: " << noiseKernelName(activeNoiseKernel()) 
+        << ", octaves: " << world.getActiveOctaves() << std::endl;
+
+    // Every tree is an instance of the same mesh. They are culled in clusters on the chunk
+    // grid, and each run of visible clusters is drawn with a single instanced call
+    tree.setInstances(world.scatterInstances(50000, 512.0f, 1), world.getChunkWidth());
+
+    // Keeps chunks within 4 chunks of the camera, unloading them once they are over 5 away
+    // and sending at most 2 finished chunks to the GPU each frame. Chunks over 64 units
+    // away drop to lower levels of detail
+    ChunkManager chunkManager(world, 4, 5, 2, 64.0f);
 
-    World world = World(0, 200, 2, 32);
-    std::vector<std::vector<float>> chunk = world.generateChunk(0, 0);
+    // Every draw goes through the queue, which binds each program, texture and vertex array
+    // once per group of draws sharing it
+    RenderQueue renderQueue(10000.0f);
+
+    float lastStatsTime = 0.0f;
 
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
@@ -78,27 +117,19 @@ int main() {
         glClearColor(0.38, 0.58, 0.98, 1.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
-        mat4 view = camera.getView();
-        shader.use();
-        int viewLoc = glGetUniformLocation(shader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_TRUE, view.m);
-        int lightPosLocation = glGetUniformLocation(shader.ID, "lightPos");
-        glUniform3f(lightPosLocation, 500.0f, 70.0f, 100.0f);
-        int lightColorLocation = glGetUniformLocation(shader.ID, "lightColor");
-        glUniform3f(lightColorLocation, 1.0f, 1.0f, 1.0f);
-        
-        Worldshader.use();
-        viewLoc = glGetUniformLocation(Worldshader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_TRUE, view.m);
-        int objectColorLocation = glGetUniformLocation(Worldshader.ID, "objectColor");
-        glUniform3f(objectColorLocation, 0.0f, 1.0f, 0.0f);
-        lightPosLocation = glGetUniformLocation(Worldshader.ID, "lightPos");
-        glUniform3f(lightPosLocation, 500.0f, 70.0f, 100.0f);
-        lightColorLocation = glGetUniformLocation(Worldshader.ID, "lightColor");
-        glUniform3f(lightColorLocation, 1.0f, 1.0f, 1.0f);
-
-        world.drawChunk(chunk, Worldshader);
-        tree.drawObject();
+        frameData.view = camera.getView();
+        frameUniforms.update(frameData);
+
+        FrameStats frameStats;
+        frustum viewFrustum = camera.getFrustum();
+
+        textures.update();
+        chunkManager.update(camera.getPosition());
+        chunkManager.draw(renderQueue, Worldshader, viewFrustum, frameStats);
+
+        tree.submit(renderQueue, viewFrustum, camera.getPosition(), frameStats);
+
+        renderQueue.flush();
 
         GLenum err;
         while ((err = glGetError()) != GL_NO_ERROR) {
@@ -110,8 +141,26 @@ int main() {
 
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame; 
+
+        if (currentFrame - lastStatsTime >= 1.0f) {
+            const ChunkStats& stats = chunkManager.getStats();
+            std::string title = "OpenGL Window - chunks resident: " + std::to_string(stats.resident) 
+                + " pending: " + std::to_string(stats.pending) 
+                + " evicted: " + std::to_string(stats.evictions)
+                + " triangles: " + std::to_string(stats.triangles)
+                + " terrain draw calls: " + std::to_string(stats.drawCalls)
+                + (stats.multiDrawIndirect ? " (multi-draw)" : " (fallback)")
+                + " drawn: " + std::to_string(frameStats.drawn)
+                + " culled: " + std::to_string(frameStats.culled);
+            glfwSetWindowTitle(window, title.c_str());
+            lastStatsTime = currentFrame;
+        }
     }
 
+    chunkManager.release();
+    textures.release();
+    frameUniforms.release();
+
     shader.deleteShader();
     Worldshader.deleteShader();
 
@@ -0,0 +1,52 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "vec3.h"
+
+struct aabb {
+    vec3 min, max;
+
+    aabb(vec3 min = vec3(), vec3 max = vec3()) : min(min), max(max) {}
+
+    vec3 center() const 
+    {
+        return (min + max) * 0.5f;
+    }
+
+    // Half the size along each axis
+    vec3 extents() const 
+    {
+        return (max - min) * 0.5f;
+    }
+
+    // Grows the box to contain the point
+    void expand(const vec3& point)
+    {
+        min = vec3(std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z));
+        max = vec3(std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z));
+    }
+
+    aabb translated(const vec3& offset) const 
+    {
+        return aabb(min + offset, max + offset);
+    }
+};
+
+struct sphere {
+    vec3 center;
+    float radius;
+
+    sphere(vec3 center = vec3(), float radius = 0) : center(center), radius(radius) {}
+
+    // Smallest sphere around the box
+    static sphere fromAabb(const aabb& box)
+    {
+        vec3 e = box.extents();
+        return sphere(box.center(), std::sqrt(e.x*e.x + e.y*e.y + e.z*e.z));
+    }
+};
+
+#endif
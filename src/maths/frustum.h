@@ -0,0 +1,68 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cmath>
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "aabb.h"
+
+struct frustum {
+    // Left, right, bottom, top, near and far planes as (normal, distance) with the normals
+    // pointing inwards, so points inside give a positive distance for every plane
+    vec4 planes[6];
+
+    // Extracts the planes from a combined projection * view matrix (Gribb and Hartmann)
+    static frustum fromMatrix(const mat4& viewProjection)
+    {
+        const float* m = viewProjection.m;
+        vec4 rows[4] = {
+            vec4(m[0], m[1], m[2], m[3]),
+            vec4(m[4], m[5], m[6], m[7]),
+            vec4(m[8], m[9], m[10], m[11]),
+            vec4(m[12], m[13], m[14], m[15])
+        };
+
+        frustum result;
+        result.planes[0] = rows[3] + rows[0];
+        result.planes[1] = rows[3] - rows[0];
+        result.planes[2] = rows[3] + rows[1];
+        result.planes[3] = rows[3] - rows[1];
+        result.planes[4] = rows[3] + rows[2];
+        result.planes[5] = rows[3] - rows[2];
+
+        for (vec4& plane : result.planes) {
+            float length = std::sqrt(plane.x*plane.x + plane.y*plane.y + plane.z*plane.z);
+            plane = plane / length;
+        }
+        return result;
+    }
+
+    bool intersects(const aabb& box) const 
+    {
+        vec3 c = box.center();
+        vec3 e = box.extents();
+
+        for (const vec4& p : planes) {
+            float distance = p.x*c.x + p.y*c.y + p.z*c.z + p.w;
+            float radius = e.x*std::fabs(p.x) + e.y*std::fabs(p.y) + e.z*std::fabs(p.z);
+            if (distance + radius < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool intersects(const sphere& s) const 
+    {
+        for (const vec4& p : planes) {
+            if (p.x*s.center.x + p.y*s.center.y + p.z*s.center.z + p.w < -s.radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
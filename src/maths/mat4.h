@@ -37,6 +37,15 @@ struct mat4 {
         return result;
     }
 
+    static mat4 scale(const vec3& factors) 
+    {
+        mat4 result = identity();
+        result.m[0] = factors.x;
+        result.m[5] = factors.y;
+        result.m[10] = factors.z;
+        return result;
+    }
+
     static mat4 rotate(float angle, const vec3& axis) 
     {
         vec3 axisNorm = axis.normalize();
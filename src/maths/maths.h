@@ -7,5 +7,7 @@
 #include "quaternion.h"
 
 #include "mat4.h"
+#include "aabb.h"
+#include "frustum.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The contents stay valid until the
+// mapping is closed or destroyed
+class MappedFile
+{
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const char* path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const char* path);
+        void close();
+
+        // Empty files are open but have no data
+        bool isOpen() const { return opened; }
+        const char* data() const { return contents; }
+        size_t size() const { return length; }
+
+    private:
+        const char* contents = nullptr;
+        size_t length = 0;
+        bool opened = false;
+
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+};
+
+#endif
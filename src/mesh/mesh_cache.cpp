@@ -0,0 +1,247 @@
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "cache_file.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <glad/glad.h>
+
+namespace {
+
+const char meshCacheMagic[4] = {'O', 'W', 'M', 'C'};
+
+size_t alignBlob(size_t offset)
+{
+    return (offset + 15) & ~(size_t)15;
+}
+
+inline uint64_t mixHash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Checks the blob is complete and was written by this version of the cooker
+const MeshCacheHeader* validateBlob(const char* data, size_t size)
+{
+    if (size < sizeof(MeshCacheHeader)) {
+        return nullptr;
+    }
+
+    const MeshCacheHeader* header = (const MeshCacheHeader*)data;
+    if (std::memcmp(header->magic, meshCacheMagic, sizeof(meshCacheMagic)) != 0 || header->version != meshCacheVersion) {
+        return nullptr;
+    }
+
+    uint64_t vertexBytes = (uint64_t)header->vertexCount * header->vertexStride;
+    uint64_t indexBytes = (uint64_t)header->indexCount * header->indexSize;
+    if (header->totalSize != size || header->attributeCount > maxMeshAttributes ||
+        (header->indexSize != 2 && header->indexSize != 4) ||
+        header->vertexOffset + vertexBytes > size || header->indexOffset + indexBytes > size) {
+        return nullptr;
+    }
+
+    return header;
+}
+
+// Records the source's new modification time after a hit on its contents, so the next
+// load is trusted from the time again instead of hashing the whole source. The cache
+// must not be mapped, since Windows refuses writers while it is
+bool updateSourceTime(const std::string& path, int64_t time)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) {
+        return false;
+    }
+
+    file.seekp(offsetof(MeshCacheHeader, sourceTime));
+    file.write((const char*)&time, sizeof(time));
+    file.flush();
+    return (bool)file;
+}
+
+}
+
+uint64_t hashMeshSource(const char* data, size_t size)
+{
+    // Four independent lanes keep the multiplies pipelined on large files
+    uint64_t lanes[4] = {
+        0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x85EBCA77C2B2AE63ull
+    };
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ word) * 0x9FB21C651E98DF25ull;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    uint64_t h = size;
+    for (int lane = 0; lane < 4; lane++) {
+        h = mixHash(h ^ lanes[lane]);
+    }
+
+    for (; i < size; i++) {
+        h = (h ^ (unsigned char)data[i]) * 0x100000001B3ull;
+    }
+
+    return mixHash(h);
+}
+
+void cookMesh(const MeshData& mesh, const MeshSourceInfo& source, std::vector<char>& blob)
+{
+    MeshCacheHeader header = {};
+    std::memcpy(header.magic, meshCacheMagic, sizeof(meshCacheMagic));
+    header.version = meshCacheVersion;
+    header.sourceSize = source.size;
+    header.sourceTime = source.time;
+    header.sourceHash = source.hash;
+
+    header.vertexCount = mesh.vertexCount();
+    header.vertexStride = MeshData::floatsPerVertex * sizeof(float);
+    header.attributeCount = 3;
+    header.attributes[0] = {0, 3, GL_FLOAT, 0};
+    header.attributes[1] = {1, 2, GL_FLOAT, 3 * sizeof(float)};
+    header.attributes[2] = {2, 3, GL_FLOAT, 5 * sizeof(float)};
+
+    header.indexCount = mesh.indices.size();
+    header.indexSize = header.vertexCount <= 65536 ? 2 : 4;
+
+    for (int axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = 0.0f;
+        header.boundsMax[axis] = 0.0f;
+    }
+    for (size_t i = 0; i < mesh.vertices.size(); i += MeshData::floatsPerVertex) {
+        for (int axis = 0; axis < 3; axis++) {
+            float value = mesh.vertices[i + axis];
+            if (i == 0 || value < header.boundsMin[axis]) {
+                header.boundsMin[axis] = value;
+            }
+            if (i == 0 || value > header.boundsMax[axis]) {
+                header.boundsMax[axis] = value;
+            }
+        }
+    }
+
+    header.vertexOffset = alignBlob(sizeof(MeshCacheHeader));
+    header.indexOffset = alignBlob(header.vertexOffset + (size_t)header.vertexCount * header.vertexStride);
+    header.totalSize = alignBlob(header.indexOffset + (size_t)header.indexCount * header.indexSize);
+
+    blob.assign(header.totalSize, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    std::memcpy(blob.data() + header.vertexOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+
+    if (header.indexSize == 2) {
+        uint16_t* indices = (uint16_t*)(blob.data() + header.indexOffset);
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+            indices[i] = (uint16_t)mesh.indices[i];
+        }
+    }
+    else {
+        std::memcpy(blob.data() + header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+    }
+}
+
+bool CookedMesh::load(const char* sourcePath, ThreadPool* pool)
+{
+    std::string cachePath = std::string(sourcePath) + ".cooked";
+
+    MeshSourceInfo source;
+    bool haveSource = readSourceInfo(sourcePath, source.size, source.time);
+
+    MappedFile sourceFile;
+    if (file.open(cachePath.c_str())) {
+        const MeshCacheHeader* cached = validateBlob(file.data(), file.size());
+
+        // A matching size and modification time is trusted without reading the source.
+        // Otherwise the contents decide, so touched or copied files still hit the cache.
+        // Without the source the cache is used as shipped
+        bool upToDate = false;
+        bool refreshTime = false;
+        if (cached && !haveSource) {
+            upToDate = true;
+        }
+        else if (cached && cached->sourceSize == source.size) {
+            upToDate = cached->sourceTime == source.time;
+            if (!upToDate && sourceFile.open(sourcePath)) {
+                source.hash = hashMeshSource(sourceFile.data(), sourceFile.size());
+                upToDate = cached->sourceHash == source.hash;
+                refreshTime = upToDate;
+            }
+        }
+
+        // The header is rewritten with the cache unmapped, then mapped again. A failed write
+        // only means hashing the source again next time
+        if (refreshTime) {
+            file.close();
+            if (!updateSourceTime(cachePath, source.time)) {
+                std::cerr << "Warning: could not update mesh cache " << cachePath << std::endl;
+            }
+
+            cached = file.open(cachePath.c_str()) ? validateBlob(file.data(), file.size()) : nullptr;
+            upToDate = cached && cached->sourceHash == source.hash;
+        }
+
+        if (upToDate) {
+            data = file.data();
+            header = cached;
+            fromCache = true;
+            return true;
+        }
+        file.close();
+    }
+
+    if (!haveSource || (!sourceFile.isOpen() && !sourceFile.open(sourcePath))) {
+        std::cerr << "Failed to open OBJ file: " << sourcePath << std::endl;
+        return false;
+    }
+
+    MeshData mesh;
+    bool parsed = pool ? parseObj(sourceFile.data(), sourceFile.size(), mesh, *pool, sourcePath)
+        : parseObj(sourceFile.data(), sourceFile.size(), mesh, sourcePath);
+    if (!parsed) {
+        return false;
+    }
+    source.hash = hashMeshSource(sourceFile.data(), sourceFile.size());
+
+    // Cooking is the one time cost, so the mesh is reordered for the vertex cache,
+    // overdraw and vertex fetch before it is stored
+    VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+    std::vector<size_t> clusters;
+    optimizeVertexCache(mesh.indices, mesh.vertexCount(), &clusters);
+    optimizeOverdraw(mesh.indices, clusters, mesh.vertices.data(), MeshData::floatsPerVertex);
+    optimizeVertexFetch(mesh.vertices, mesh.indices, MeshData::floatsPerVertex);
+    VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+
+    std::cout << "Cooked " << sourcePath << ": ACMR " << before.acmr << " -> " << after.acmr
+        << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
+    cookMesh(mesh, source, blob);
+    data = blob.data();
+    header = (const MeshCacheHeader*)data;
+    fromCache = false;
+
+    if (!writeFileAtomically(cachePath, {{blob.data(), blob.size()}})) {
+        std::cerr << "Warning: could not write mesh cache " << cachePath << std::endl;
+    }
+    return true;
+}
+
+aabb CookedMesh::getBounds() const
+{
+    return aabb(
+        vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]),
+        vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2])
+    );
+}
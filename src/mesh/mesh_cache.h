@@ -0,0 +1,94 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mapped_file.h"
+#include "obj_loader.h"
+#include "maths/aabb.h"
+
+// Bumped whenever the blob layout or the cooking steps change, which invalidates every cache
+constexpr uint32_t meshCacheVersion = 2;
+constexpr unsigned maxMeshAttributes = 4;
+
+// One vertex attribute, with type a GL component type such as GL_FLOAT
+struct MeshAttribute
+{
+    uint32_t location;
+    uint32_t components;
+    uint32_t type;
+    uint32_t offset;
+};
+
+// Start of a cooked mesh blob. The vertex and index data follow at the given offsets,
+// each aligned to 16 bytes
+struct MeshCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    // Identify the source the blob was cooked from
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t sourceHash;
+
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    uint32_t attributeCount;
+    MeshAttribute attributes[maxMeshAttributes];
+
+    uint32_t indexCount;
+    // 2 or 4 bytes per index
+    uint32_t indexSize;
+
+    float boundsMin[3];
+    float boundsMax[3];
+
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t totalSize;
+};
+
+// A model ready for upload, either mapped from its cache or freshly cooked from the source
+class CookedMesh
+{
+    public:
+        // Maps the cache next to sourcePath when it is up to date. Otherwise the OBJ is
+        // loaded, cooked and written back to the cache for the next run, parsing on the
+        // pool when one is given
+        bool load(const char* sourcePath, ThreadPool* pool = nullptr);
+
+        const MeshCacheHeader& getHeader() const { return *header; }
+        const void* getVertexData() const { return data + header->vertexOffset; }
+        const void* getIndexData() const { return data + header->indexOffset; }
+        size_t getVertexBytes() const { return (size_t)header->vertexCount * header->vertexStride; }
+        size_t getIndexBytes() const { return (size_t)header->indexCount * header->indexSize; }
+        aabb getBounds() const;
+
+        // True if the mesh came from the cache rather than the source file
+        bool isFromCache() const { return fromCache; }
+
+    private:
+        MappedFile file;
+        std::vector<char> blob;
+        const char* data = nullptr;
+        const MeshCacheHeader* header = nullptr;
+        bool fromCache = false;
+};
+
+struct MeshSourceInfo
+{
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t hash = 0;
+};
+
+// Serialises an interleaved position, texture coordinate and normal mesh into a cache blob,
+// using 16-bit indices when every vertex can be addressed with them
+void cookMesh(const MeshData& mesh, const MeshSourceInfo& source, std::vector<char>& blob);
+
+// 64-bit hash of the source file contents
+uint64_t hashMeshSource(const char* data, size_t size);
+
+#endif
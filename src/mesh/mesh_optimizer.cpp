@@ -0,0 +1,278 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Smallest run of triangles optimizeVertexCache reports as a cluster
+const size_t minClusterTriangles = 128;
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    if (indices.empty()) {
+        return stats;
+    }
+
+    // A vertex is in the cache while fewer than cacheSize misses happened since it was loaded
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t misses = 0;
+    size_t unique = 0;
+
+    for (unsigned int index : indices) {
+        if (!referenced[index]) {
+            referenced[index] = true;
+            unique++;
+        }
+
+        if (loadedAt[index] == 0 || misses - loadedAt[index] + 1 > cacheSize) {
+            misses++;
+            loadedAt[index] = misses;
+        }
+    }
+
+    stats.acmr = (float)misses / (indices.size() / 3);
+    stats.atvr = (float)misses / unique;
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* clusters)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (clusters) {
+        clusters->clear();
+    }
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles using each vertex, in compressed rows
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (unsigned int index : indices) {
+        liveTriangles[index]++;
+    }
+
+    std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            adjacency[fill[indices[t * 3 + corner]]++] = t;
+        }
+    }
+
+    const int cacheSize = vertexCacheSize;
+    std::vector<int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    int time = cacheSize + 1;
+    size_t cursor = 0;
+
+    // Start from the first vertex which is used at all
+    long long fanning = -1;
+    while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+        cursor++;
+    }
+    fanning = cursor < vertexCount ? (long long)cursor : -1;
+    if (clusters) {
+        clusters->push_back(0);
+    }
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (size_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int v = indices[t * 3 + corner];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time++;
+                }
+            }
+        }
+
+        // Prefer the candidate furthest along in the cache whose remaining triangles
+        // will still find it there
+        long long next = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates) {
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * (int)liveTriangles[v] <= cacheSize) {
+                priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        // Otherwise fall back on recently used vertices, then on any vertex left
+        if (next < 0) {
+            while (!deadEnd.empty() && next < 0) {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0) {
+                    next = v;
+                }
+            }
+
+            while (next < 0 && cursor < vertexCount) {
+                if (liveTriangles[cursor] > 0) {
+                    next = cursor;
+                }
+                cursor++;
+            }
+
+            // Tiny clusters would let overdraw ordering undo the cache locality
+            if (clusters && next >= 0 && output.size() - clusters->back() >= minClusterTriangles * 3) {
+                clusters->push_back(output.size());
+            }
+        }
+
+        fanning = next;
+    }
+
+    indices.swap(output);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<size_t>& clusters,
+    const float* positions, size_t stride)
+{
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    struct Cluster
+    {
+        size_t begin;
+        size_t end;
+        float sortKey;
+    };
+
+    auto position = [&](unsigned int index, int axis) {
+        return positions[index * stride + axis];
+    };
+
+    // Area weighted centroid of the whole mesh
+    double meshCentroid[3] = {0.0, 0.0, 0.0};
+    double meshArea = 0.0;
+
+    std::vector<Cluster> order(clusters.size());
+    std::vector<double> clusterData(clusters.size() * 7, 0.0);
+
+    for (size_t c = 0; c < clusters.size(); c++) {
+        order[c].begin = clusters[c];
+        order[c].end = c + 1 < clusters.size() ? clusters[c + 1] : indices.size();
+
+        double centroid[3] = {0.0, 0.0, 0.0};
+        double normal[3] = {0.0, 0.0, 0.0};
+        double area = 0.0;
+
+        for (size_t i = order[c].begin; i < order[c].end; i += 3) {
+            unsigned int a = indices[i], b = indices[i + 1], d = indices[i + 2];
+            double e1[3], e2[3];
+            for (int axis = 0; axis < 3; axis++) {
+                e1[axis] = position(b, axis) - position(a, axis);
+                e2[axis] = position(d, axis) - position(a, axis);
+            }
+
+            // Twice the area weighted face normal
+            double n[3] = {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0]
+            };
+            double triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int axis = 0; axis < 3; axis++) {
+                double center = (position(a, axis) + position(b, axis) + position(d, axis)) / 3.0;
+                centroid[axis] += center * triangleArea;
+                normal[axis] += n[axis];
+            }
+            area += triangleArea;
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            meshCentroid[axis] += centroid[axis];
+            clusterData[c * 7 + axis] = area > 0.0 ? centroid[axis] / area : 0.0;
+            clusterData[c * 7 + 3 + axis] = normal[axis];
+        }
+        clusterData[c * 7 + 6] = area;
+        meshArea += area;
+    }
+
+    if (meshArea <= 0.0) {
+        return;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        meshCentroid[axis] /= meshArea;
+    }
+
+    // Clusters far out along their own normal face away from the rest of the mesh
+    for (size_t c = 0; c < clusters.size(); c++) {
+        const double* data = &clusterData[c * 7];
+        double length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+        double key = 0.0;
+        if (length > 0.0) {
+            for (int axis = 0; axis < 3; axis++) {
+                key += (data[axis] - meshCentroid[axis]) * data[3 + axis] / length;
+            }
+        }
+        order[c].sortKey = key;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : order) {
+        output.insert(output.end(), indices.begin() + cluster.begin, indices.begin() + cluster.end);
+    }
+    indices.swap(output);
+}
+
+void optimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t floatsPerVertex)
+{
+    const size_t vertexCount = vertices.size() / floatsPerVertex;
+    const unsigned int unassigned = ~0u;
+
+    std::vector<unsigned int> remap(vertexCount, unassigned);
+    std::vector<float> output;
+    output.reserve(vertices.size());
+    unsigned int next = 0;
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == unassigned) {
+            remap[index] = next++;
+            output.insert(output.end(), vertices.begin() + index * floatsPerVertex, vertices.begin() + (index + 1) * floatsPerVertex);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(output);
+}
@@ -0,0 +1,38 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+// Post-transform vertex cache efficiency of a triangle list, simulated with a FIFO cache
+struct VertexCacheStats
+{
+    // Vertices transformed per triangle, from 0.5 at best up to 3
+    float acmr = 0.0f;
+    // Vertices transformed per referenced vertex, 1 at best
+    float atvr = 0.0f;
+};
+
+// Cache size of the simulation, and the one the optimiser targets
+constexpr unsigned vertexCacheSize = 16;
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned cacheSize = vertexCacheSize);
+
+// Reorders triangles for vertex cache locality with Tipsify (Sander, Nehab and Barczak,
+// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). When clusters is
+// given, it receives the index offset where each run of triangles starts after the cache
+// locality was broken, for optimizeOverdraw
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* clusters = nullptr);
+
+// Reorders the clusters from optimizeVertexCache so that outward facing clusters, which
+// are the most likely to occlude the rest of the mesh, are drawn first. positions holds
+// three floats for each vertex, stride floats apart
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<size_t>& clusters,
+    const float* positions, size_t stride);
+
+// Reorders vertices into the order the indices first use them, so vertex fetch walks the
+// buffer forwards, and remaps the indices to match. Unreferenced vertices are dropped.
+// Vertices are floatsPerVertex floats each
+void optimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t floatsPerVertex);
+
+#endif
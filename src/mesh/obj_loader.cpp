@@ -0,0 +1,667 @@
+#include "obj_loader.h"
+#include "mapped_file.h"
+#include "vertex_map.h"
+#include "jobs/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Exactly representable powers of ten. Numbers needing larger ones are rare enough
+// to hand to strtof
+const double exactPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isDigit(char c)
+{
+    return (unsigned)(c - '0') < 10u;
+}
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+inline const char* skipLine(const char* p, const char* end)
+{
+    const char* newline = (const char*)std::memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+// Parses a decimal float with an optional sign, fraction and exponent. Returns the
+// character after the number, or nullptr if there are no digits
+const char* parseFloat(const char* p, const char* end, float& out)
+{
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    // Up to 19 significant digits fit in the mantissa, later ones only move the exponent
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    while (p < end && isDigit(*p)) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) {
+                digits++;
+            }
+        }
+        else {
+            exponent++;
+        }
+        any = true;
+        p++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) {
+                    digits++;
+                }
+                exponent--;
+            }
+            any = true;
+            p++;
+        }
+    }
+
+    if (!any) {
+        return nullptr;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            e++;
+        }
+
+        if (e < end && isDigit(*e)) {
+            int value = 0;
+            while (e < end && isDigit(*e)) {
+                if (value < 10000) {
+                    value = value * 10 + (*e - '0');
+                }
+                e++;
+            }
+            exponent += negativeExponent ? -value : value;
+            p = e;
+        }
+    }
+
+    // With a mantissa below 2^53 and an exact power of ten the double result is
+    // correctly rounded. Narrowing it to float rounds a second time, which can only
+    // differ from rounding the exact value once when the double lands exactly halfway
+    // between two floats, so those and anything out of range take the exact path
+    double result = 0.0;
+    bool exact = mantissa == 0 || (mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22);
+    if (exact && mantissa != 0) {
+        result = (double)mantissa;
+        if (exponent > 0) {
+            result *= exactPowersOf10[exponent];
+        }
+        else if (exponent < 0) {
+            result /= exactPowersOf10[-exponent];
+        }
+
+        // The 29 low bits of the double's mantissa are the ones rounding to float drops
+        uint64_t bits;
+        std::memcpy(&bits, &result, sizeof(bits));
+        exact = (bits & 0x1FFFFFFFull) != 0x10000000ull;
+    }
+
+    if (!exact) {
+        char buffer[128];
+        size_t length = std::min<size_t>(p - start, sizeof(buffer) - 1);
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        out = std::strtof(buffer, nullptr);
+        return p;
+    }
+
+    out = (float)(negative ? -result : result);
+    return p;
+}
+
+const char* parseInt(const char* p, const char* end, int& out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    if (p >= end || !isDigit(*p)) {
+        return nullptr;
+    }
+
+    // Values outside the range of int are malformed, as they were for stream extraction
+    const long long limit = negative ? -(long long)INT32_MIN : INT32_MAX;
+    long long value = 0;
+    while (p < end && isDigit(*p)) {
+        value = value * 10 + (*p - '0');
+        if (value > limit) {
+            return nullptr;
+        }
+        p++;
+    }
+
+    out = (int)(negative ? -value : value);
+    return p;
+}
+
+// Reads count floats separated by blanks
+const char* parseFloats(const char* p, const char* end, float* out, int count)
+{
+    for (int i = 0; i < count; i++) {
+        p = skipBlanks(p, end);
+        p = parseFloat(p, end, out[i]);
+        if (!p) {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+// Flags for corner indices written relative to the end of the slice's own attributes
+enum : uint8_t
+{
+    RELATIVE_POSITION = 1,
+    RELATIVE_TEX_COORD = 2,
+    RELATIVE_NORMAL = 4
+};
+
+// Face corner, zero-based with -1 for a missing attribute
+struct ObjCorner
+{
+    int position;
+    int texCoord;
+    int normal;
+};
+
+// A run of whole lines, parsed independently of every other slice. Indices written
+// as negative numbers can only be resolved once the attribute counts of the earlier
+// slices are known, so they are kept relative to this slice until then
+struct ObjSlice
+{
+    const char* begin;
+    const char* end;
+
+    std::vector<float> positions;
+    std::vector<float> texCoords;
+    std::vector<float> normals;
+
+    std::vector<ObjCorner> corners;
+    std::vector<uint8_t> relative;
+    std::vector<uint32_t> faceSizes;
+    std::vector<uint32_t> faceLines;
+
+    unsigned lines = 0;
+    unsigned errorLine = 0;
+    const char* error = nullptr;
+
+    // Filled in from the prefix sums over earlier slices
+    size_t positionOffset = 0;
+    size_t texCoordOffset = 0;
+    size_t normalOffset = 0;
+    size_t cornerOffset = 0;
+    size_t indexOffset = 0;
+    unsigned lineOffset = 0;
+    size_t uniqueCount = 0;
+    size_t uniqueOffset = 0;
+};
+
+// Runs job(i) for i in [0, count), on the pool when there is one
+template <typename Job>
+void runJobs(ThreadPool* pool, size_t count, const Job& job)
+{
+    if (!pool || count == 1) {
+        for (size_t i = 0; i < count; i++) {
+            job(i);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        pool->submit([&job, i]() { job(i); });
+    }
+    pool->wait();
+}
+
+// Parses an OBJ index, which is one-based when positive and counts back from the
+// latest attribute when negative. Zero is stored for a missing index
+const char* parseCornerIndex(const char* p, const char* end, size_t count, int& out, bool& relative)
+{
+    int index;
+    p = parseInt(p, end, index);
+    if (!p || index == 0) {
+        return nullptr;
+    }
+
+    relative = index < 0;
+    out = relative ? (int)count + index : index - 1;
+    return p;
+}
+
+void parseSlice(ObjSlice& slice)
+{
+    const char* p = slice.begin;
+    const char* end = slice.end;
+
+    auto fail = [&](const char* message) {
+        slice.error = message;
+        slice.errorLine = slice.lines;
+    };
+
+    while (p < end) {
+        slice.lines++;
+        p = skipBlanks(p, end);
+        if (p >= end) {
+            break;
+        }
+
+        char c = *p;
+        char next = p + 1 < end ? p[1] : '\n';
+
+        if (c == 'v' && isBlank(next)) {
+            float position[3];
+            p = parseFloats(p + 1, end, position, 3);
+            if (!p) {
+                return fail("invalid vertex position");
+            }
+            slice.positions.insert(slice.positions.end(), position, position + 3);
+        }
+
+        else if (c == 'v' && next == 't' && p + 2 < end && isBlank(p[2])) {
+            float texCoord[2];
+            p = parseFloats(p + 2, end, texCoord, 2);
+            if (!p) {
+                return fail("invalid texture coordinate");
+            }
+            slice.texCoords.insert(slice.texCoords.end(), texCoord, texCoord + 2);
+        }
+
+        else if (c == 'v' && next == 'n' && p + 2 < end && isBlank(p[2])) {
+            float normal[3];
+            p = parseFloats(p + 2, end, normal, 3);
+            if (!p) {
+                return fail("invalid vertex normal");
+            }
+            slice.normals.insert(slice.normals.end(), normal, normal + 3);
+        }
+
+        else if (c == 'f' && isBlank(next)) {
+            p++;
+            uint32_t size = 0;
+
+            while (true) {
+                p = skipBlanks(p, end);
+                if (p >= end || *p == '\n' || *p == '\r' || *p == '#') {
+                    break;
+                }
+
+                ObjCorner corner = {-1, -1, -1};
+                uint8_t flags = 0;
+                bool relative;
+
+                p = parseCornerIndex(p, end, slice.positions.size() / 3, corner.position, relative);
+                if (!p) {
+                    return fail("invalid face");
+                }
+                flags |= relative ? RELATIVE_POSITION : 0;
+
+                if (p < end && *p == '/') {
+                    p++;
+                    // v//vn leaves the texture coordinate out
+                    if (p < end && *p != '/') {
+                        p = parseCornerIndex(p, end, slice.texCoords.size() / 2, corner.texCoord, relative);
+                        if (!p) {
+                            return fail("invalid face texture coordinate index");
+                        }
+                        flags |= relative ? RELATIVE_TEX_COORD : 0;
+                    }
+                    if (p < end && *p == '/') {
+                        p = parseCornerIndex(p + 1, end, slice.normals.size() / 3, corner.normal, relative);
+                        if (!p) {
+                            return fail("invalid face normal index");
+                        }
+                        flags |= relative ? RELATIVE_NORMAL : 0;
+                    }
+                }
+
+                slice.corners.push_back(corner);
+                slice.relative.push_back(flags);
+                size++;
+            }
+
+            if (size < 3) {
+                return fail("face has fewer than three vertices");
+            }
+            slice.faceSizes.push_back(size);
+            slice.faceLines.push_back(slice.lines);
+        }
+
+        // Anything after the values, such as a w component or a comment, is ignored
+        // along with every other record type
+        p = skipLine(p, end);
+    }
+}
+
+// Turns slice-relative corner indices into indices into the merged attribute arrays
+void resolveSlice(ObjSlice& slice, size_t positionCount, size_t texCoordCount, size_t normalCount)
+{
+    size_t face = 0;
+    size_t faceEnd = slice.faceSizes.empty() ? 0 : slice.faceSizes[0];
+
+    for (size_t i = 0; i < slice.corners.size(); i++) {
+        while (i >= faceEnd) {
+            faceEnd += slice.faceSizes[++face];
+        }
+
+        ObjCorner& corner = slice.corners[i];
+        uint8_t flags = slice.relative[i];
+        if (flags & RELATIVE_POSITION) {
+            corner.position += slice.positionOffset;
+        }
+        if (flags & RELATIVE_TEX_COORD) {
+            corner.texCoord += slice.texCoordOffset;
+        }
+        if (flags & RELATIVE_NORMAL) {
+            corner.normal += slice.normalOffset;
+        }
+
+        // Missing attributes stay at -1, anything else must exist somewhere in the file
+        bool valid = corner.position >= 0 && (size_t)corner.position < positionCount &&
+            corner.texCoord >= -1 && (corner.texCoord < 0 || (size_t)corner.texCoord < texCoordCount) &&
+            corner.normal >= -1 && (corner.normal < 0 || (size_t)corner.normal < normalCount);
+        // A relative index reaching before the start of the file can land on -1
+        valid = valid && !((flags & RELATIVE_TEX_COORD) && corner.texCoord < 0) &&
+            !((flags & RELATIVE_NORMAL) && corner.normal < 0);
+
+        if (!valid) {
+            slice.error = "face index out of range";
+            slice.errorLine = slice.faceLines[face];
+            return;
+        }
+    }
+}
+
+bool reportSliceErrors(const std::vector<ObjSlice>& slices, const char* name)
+{
+    for (const ObjSlice& slice : slices) {
+        if (slice.error) {
+            std::cerr << "Error: " << name << ":" << slice.lineOffset + slice.errorLine << ": " << slice.error << std::endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Splits the text into roughly equal slices, each starting at the beginning of a line
+std::vector<ObjSlice> splitSlices(const char* text, size_t size, size_t count)
+{
+    std::vector<ObjSlice> slices;
+    const char* end = text + size;
+    const char* begin = text;
+
+    for (size_t i = 1; i <= count && begin < end; i++) {
+        const char* split = i == count ? end : text + size / count * i;
+        if (split < begin) {
+            split = begin;
+        }
+        split = split < end ? skipLine(split, end) : end;
+
+        ObjSlice slice;
+        slice.begin = begin;
+        slice.end = split;
+        slices.push_back(std::move(slice));
+        begin = split;
+    }
+
+    return slices;
+}
+
+bool parseObjSlices(const char* text, size_t size, MeshData& mesh, const char* name, ThreadPool* pool)
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    // Slices are several times the thread count to even out the work, but big enough
+    // that the per-slice overhead does not matter
+    const size_t minimumSliceBytes = 256 * 1024;
+    size_t sliceCount = 1;
+    if (pool) {
+        sliceCount = std::max<size_t>(1, std::min<size_t>(pool->size() * 4, size / minimumSliceBytes));
+    }
+    std::vector<ObjSlice> slices = splitSlices(text, size, sliceCount);
+    sliceCount = slices.size();
+
+    runJobs(pool, sliceCount, [&](size_t i) { parseSlice(slices[i]); });
+
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0, indexCount = 0;
+    unsigned lineCount = 0;
+    for (ObjSlice& slice : slices) {
+        slice.positionOffset = positionCount;
+        slice.texCoordOffset = texCoordCount;
+        slice.normalOffset = normalCount;
+        slice.cornerOffset = cornerCount;
+        slice.indexOffset = indexCount;
+        slice.lineOffset = lineCount;
+
+        positionCount += slice.positions.size() / 3;
+        texCoordCount += slice.texCoords.size() / 2;
+        normalCount += slice.normals.size() / 3;
+        cornerCount += slice.corners.size();
+        for (uint32_t faceSize : slice.faceSizes) {
+            indexCount += (faceSize - 2) * 3;
+        }
+        lineCount += slice.lines;
+    }
+
+    if (reportSliceErrors(slices, name)) {
+        return false;
+    }
+
+    // Merge the attributes and resolve every corner against the merged arrays
+    std::vector<float> positions(positionCount * 3);
+    std::vector<float> texCoords(texCoordCount * 2);
+    std::vector<float> normals(normalCount * 3);
+    runJobs(pool, sliceCount, [&](size_t i) {
+        ObjSlice& slice = slices[i];
+        std::copy(slice.positions.begin(), slice.positions.end(), positions.begin() + slice.positionOffset * 3);
+        std::copy(slice.texCoords.begin(), slice.texCoords.end(), texCoords.begin() + slice.texCoordOffset * 2);
+        std::copy(slice.normals.begin(), slice.normals.end(), normals.begin() + slice.normalOffset * 3);
+        resolveSlice(slice, positionCount, texCoordCount, normalCount);
+    });
+
+    if (reportSliceErrors(slices, name)) {
+        return false;
+    }
+
+    // Missing attributes are left as zero
+    auto cornerVertex = [&](const ObjCorner& corner) {
+        const float* v = &positions[corner.position * 3];
+        const float* t = corner.texCoord >= 0 ? &texCoords[corner.texCoord * 2] : nullptr;
+        const float* n = corner.normal >= 0 ? &normals[corner.normal * 3] : nullptr;
+        return vertex(
+            v[0], v[1], v[2],
+            t ? t[0] : 0.0f, t ? t[1] : 0.0f,
+            n ? n[0] : 0.0f, n ? n[1] : 0.0f, n ? n[2] : 0.0f
+        );
+    };
+
+    const size_t shardCount = pool ? pool->size() : 1;
+    std::vector<uint32_t> shardIndices(cornerCount);
+    std::vector<uint64_t> hashes;
+    std::vector<std::vector<uint32_t>> shardFinalIndices;
+
+    auto shardOf = [shardCount](uint64_t hash) { return (size_t)((hash >> 32) % shardCount); };
+
+    if (shardCount == 1) {
+        // A single map hands out indices in file order directly
+        VertexMap map;
+        map.reserve(positionCount);
+        for (const ObjSlice& slice : slices) {
+            for (size_t c = 0; c < slice.corners.size(); c++) {
+                shardIndices[slice.cornerOffset + c] = map.insertOrGet(cornerVertex(slice.corners[c]));
+            }
+        }
+
+        const std::vector<vertex>& unique = map.getVertices();
+        mesh.vertices.resize(unique.size() * MeshData::floatsPerVertex);
+        if (!unique.empty()) {
+            std::memcpy(mesh.vertices.data(), unique.data(), unique.size() * sizeof(vertex));
+        }
+    }
+    else {
+        hashes.resize(cornerCount);
+        runJobs(pool, sliceCount, [&](size_t i) {
+            const ObjSlice& slice = slices[i];
+            for (size_t c = 0; c < slice.corners.size(); c++) {
+                hashes[slice.cornerOffset + c] = hashVertex(cornerVertex(slice.corners[c]));
+            }
+        });
+
+        // Vertices are deduplicated in shards chosen by hash, each shard walking the corners
+        // in file order. A vertex's final index is the number of unique vertices first seen
+        // before it, which is exactly the index a single map over the whole file would give
+        std::vector<VertexMap> shards(shardCount);
+        std::vector<std::vector<uint32_t>> shardFirstCorners(shardCount);
+        std::vector<uint8_t> firstSeen(cornerCount);
+
+        runJobs(pool, shardCount, [&](size_t s) {
+            VertexMap& map = shards[s];
+            std::vector<uint32_t>& firstCorners = shardFirstCorners[s];
+            map.reserve(positionCount / shardCount);
+
+            size_t slice = 0;
+            for (size_t c = 0; c < cornerCount; c++) {
+                if (shardOf(hashes[c]) != s) {
+                    continue;
+                }
+                while (c >= slices[slice].cornerOffset + slices[slice].corners.size()) {
+                    slice++;
+                }
+
+                const ObjCorner& corner = slices[slice].corners[c - slices[slice].cornerOffset];
+                unsigned int index = map.insertOrGet(cornerVertex(corner), hashes[c]);
+                if (index == firstCorners.size()) {
+                    firstCorners.push_back(c);
+                    firstSeen[c] = 1;
+                }
+                shardIndices[c] = index;
+            }
+        });
+
+        // Prefix sum of first sightings gives every unique vertex its final index
+        runJobs(pool, sliceCount, [&](size_t i) {
+            ObjSlice& slice = slices[i];
+            slice.uniqueCount = 0;
+            for (size_t c = 0; c < slice.corners.size(); c++) {
+                slice.uniqueCount += firstSeen[slice.cornerOffset + c];
+            }
+        });
+        size_t uniqueCount = 0;
+        for (ObjSlice& slice : slices) {
+            slice.uniqueOffset = uniqueCount;
+            uniqueCount += slice.uniqueCount;
+        }
+
+        std::vector<uint32_t> finalIndices(cornerCount);
+        runJobs(pool, sliceCount, [&](size_t i) {
+            const ObjSlice& slice = slices[i];
+            uint32_t next = slice.uniqueOffset;
+            for (size_t c = slice.cornerOffset; c < slice.cornerOffset + slice.corners.size(); c++) {
+                if (firstSeen[c]) {
+                    finalIndices[c] = next++;
+                }
+            }
+        });
+
+        mesh.vertices.resize(uniqueCount * MeshData::floatsPerVertex);
+        shardFinalIndices.resize(shardCount);
+        runJobs(pool, shardCount, [&](size_t s) {
+            const std::vector<vertex>& unique = shards[s].getVertices();
+            const std::vector<uint32_t>& firstCorners = shardFirstCorners[s];
+            std::vector<uint32_t>& remap = shardFinalIndices[s];
+            remap.resize(unique.size());
+
+            for (size_t u = 0; u < unique.size(); u++) {
+                remap[u] = finalIndices[firstCorners[u]];
+                std::memcpy(&mesh.vertices[(size_t)remap[u] * MeshData::floatsPerVertex], &unique[u], sizeof(vertex));
+            }
+        });
+    }
+
+    auto finalIndex = [&](size_t corner) {
+        return shardCount == 1 ? shardIndices[corner] : shardFinalIndices[shardOf(hashes[corner])][shardIndices[corner]];
+    };
+
+    // Fan triangulation, which is exact for the convex polygons exporters write
+    mesh.indices.resize(indexCount);
+    runJobs(pool, sliceCount, [&](size_t i) {
+        const ObjSlice& slice = slices[i];
+        unsigned int* out = mesh.indices.data() + slice.indexOffset;
+        size_t c = slice.cornerOffset;
+
+        for (uint32_t faceSize : slice.faceSizes) {
+            unsigned int first = finalIndex(c);
+            for (uint32_t k = 1; k + 1 < faceSize; k++) {
+                *out++ = first;
+                *out++ = finalIndex(c + k);
+                *out++ = finalIndex(c + k + 1);
+            }
+            c += faceSize;
+        }
+    });
+
+    return true;
+}
+
+}
+
+bool loadObj(const char* path, MeshData& mesh, ThreadPool* pool)
+{
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    return parseObjSlices(file.data(), file.size(), mesh, path, pool);
+}
+
+bool parseObj(const char* text, size_t size, MeshData& mesh, const char* name)
+{
+    return parseObjSlices(text, size, mesh, name, nullptr);
+}
+
+bool parseObj(const char* text, size_t size, MeshData& mesh, ThreadPool& pool, const char* name)
+{
+    return parseObjSlices(text, size, mesh, name, &pool);
+}
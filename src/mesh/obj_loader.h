@@ -0,0 +1,34 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// Indexed triangle mesh with interleaved position, texture coordinate and normal,
+// 8 floats per vertex
+struct MeshData
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+
+    static constexpr unsigned floatsPerVertex = 8;
+    size_t vertexCount() const { return vertices.size() / floatsPerVertex; }
+};
+
+// Loads the v, vt, vn and f records of a Wavefront OBJ file. Faces may use negative
+// (relative) indices, leave out the texture coordinate (v//vn) or normal (v/vt), and
+// have any number of corners, which are triangulated as a fan. Identical corners
+// share one vertex. Returns false and reports to std::cerr on failure.
+//
+// With a pool, the file is split at line boundaries and parsed and deduplicated in
+// parallel. The result is identical to the single threaded load. The pool is waited
+// on, so it should not be running other work at the same time
+bool loadObj(const char* path, MeshData& mesh, ThreadPool* pool = nullptr);
+
+// Parses OBJ text already in memory, name is only used in error messages
+bool parseObj(const char* text, size_t size, MeshData& mesh, const char* name = "<memory>");
+bool parseObj(const char* text, size_t size, MeshData& mesh, ThreadPool& pool, const char* name = "<memory>");
+
+#endif
@@ -0,0 +1,86 @@
+#include "vertex_map.h"
+
+namespace {
+
+// Slots are kept at most half full
+const size_t minimumCapacity = 64;
+
+size_t capacityFor(size_t count)
+{
+    size_t capacity = minimumCapacity;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+}
+
+VertexMap::VertexMap()
+    :slots(minimumCapacity), mask(minimumCapacity - 1)
+{
+
+}
+
+void VertexMap::reserve(size_t count)
+{
+    vertices.reserve(count);
+    if (capacityFor(count) > slots.size()) {
+        rehash(capacityFor(count));
+    }
+}
+
+unsigned int VertexMap::insertOrGet(const vertex& vert)
+{
+    return insertOrGet(vert, hashVertex(vert));
+}
+
+unsigned int VertexMap::insertOrGet(const vertex& vert, uint64_t fullHash)
+{
+    uint32_t hash = (uint32_t)fullHash;
+
+    size_t i = hash & mask;
+    while (slots[i].index != 0) {
+        if (slots[i].hash == hash && vertices[slots[i].index - 1] == vert) {
+            return slots[i].index - 1;
+        }
+        i = (i + 1) & mask;
+    }
+
+    unsigned int index = vertices.size();
+    vertices.push_back(vert);
+    slots[i] = {hash, index + 1};
+
+    if (vertices.size() * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+    }
+
+    return index;
+}
+
+void VertexMap::clear()
+{
+    vertices.clear();
+    slots.assign(minimumCapacity, Slot{0, 0});
+    mask = minimumCapacity - 1;
+}
+
+void VertexMap::rehash(size_t capacity)
+{
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.assign(capacity, Slot{0, 0});
+    mask = capacity - 1;
+
+    for (const Slot& slot : old) {
+        if (slot.index == 0) {
+            continue;
+        }
+
+        size_t i = slot.hash & mask;
+        while (slots[i].index != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef VERTEX_MAP_H
+#define VERTEX_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "vertex.h"
+
+// Deduplicates vertices, handing out indices in first-seen order. Slots live in one flat
+// array probed linearly, and each holds part of the hash so most mismatches are rejected
+// without touching the vertex itself
+class VertexMap
+{
+    public:
+        VertexMap();
+
+        // Makes room for count unique vertices without growing
+        void reserve(size_t count);
+
+        // Returns the index of an equal vertex, adding this one if there is none
+        unsigned int insertOrGet(const vertex& vert);
+        // Same as above with hashVertex(vert) already computed
+        unsigned int insertOrGet(const vertex& vert, uint64_t hash);
+
+        unsigned int size() const { return vertices.size(); }
+        // Unique vertices in index order
+        const std::vector<vertex>& getVertices() const { return vertices; }
+
+        void clear();
+
+    private:
+        struct Slot
+        {
+            uint32_t hash;
+            // Index plus one, with zero marking an empty slot
+            uint32_t index;
+        };
+
+        void rehash(size_t capacity);
+
+        std::vector<Slot> slots;
+        std::vector<vertex> vertices;
+        size_t mask;
+};
+
+#endif
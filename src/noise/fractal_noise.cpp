@@ -0,0 +1,88 @@
+#include "fractal_noise.h"
+#include "gradient_noise.h"
+
+#include <cmath>
+
+// Upper bound of 2D gradient noise with unit gradients
+static const float maxNoiseValue = 0.7072f;
+
+// Octaves with more than this many lattice cells per sample can only alias
+static const float maxFrequency = 0.5f;
+
+FractalNoise::FractalNoise(unsigned seed, const FractalNoiseSettings& settings)
+    :maxValue(0.0f)
+{
+    std::vector<float> allAmplitudes(settings.octaves);
+    float amplitude = settings.amplitude;
+    for (unsigned o = 0; o < settings.octaves; o++) {
+        allAmplitudes[o] = amplitude;
+        amplitude *= settings.gain;
+    }
+
+    // remaining is the largest value the octaves from o onwards can add together
+    float remaining = 0.0f;
+    for (float a : allAmplitudes) {
+        remaining += std::fabs(a);
+    }
+
+    float frequency = settings.frequency;
+    for (unsigned o = 0; o < settings.octaves; o++) {
+        if (o > 0 && (remaining * maxNoiseValue < settings.threshold || frequency > maxFrequency)) {
+            break;
+        }
+
+        amplitudes.push_back(allAmplitudes[o]);
+        frequencies.push_back(frequency);
+        // Separate seeds stop the octaves sharing zeros at lattice points
+        seeds.push_back(seed + o * 0x9E3779B9u);
+
+        maxValue += std::fabs(allAmplitudes[o]) * maxNoiseValue;
+        remaining -= std::fabs(allAmplitudes[o]);
+        frequency *= settings.lacunarity;
+    }
+}
+
+void FractalNoise::generate(Heightmap& map, int sample_x, int sample_y) const
+{
+    const int width = map.getWidth();
+    const int height = map.getHeight();
+    const unsigned octaves = amplitudes.size();
+
+    // Each octave hashes the gradients for just the lattice region under the map, once per
+    // lattice point. The cell bounds use the same float maths as the noise kernel
+    std::vector<std::vector<float>> gradient_x(octaves);
+    std::vector<std::vector<float>> gradient_y(octaves);
+    std::vector<GradientLattice> lattices(octaves);
+
+    for (unsigned o = 0; o < octaves; o++) {
+        const int minCell_x = (int)std::floor((float)sample_x * frequencies[o]);
+        const int minCell_y = (int)std::floor((float)sample_y * frequencies[o]);
+        const int maxCell_x = (int)std::floor((float)(sample_x + width - 1) * frequencies[o]);
+        const int maxCell_y = (int)std::floor((float)(sample_y + height - 1) * frequencies[o]);
+
+        const int gridWidth = maxCell_x - minCell_x + 2;
+        const int gridHeight = maxCell_y - minCell_y + 2;
+
+        gradient_x[o].resize(gridWidth * gridHeight);
+        gradient_y[o].resize(gridWidth * gridHeight);
+
+        for (int y = 0; y < gridHeight; y++) {
+            for (int x = 0; x < gridWidth; x++) {
+                vec2 gradient = randomGradient(seeds[o], minCell_x + x, minCell_y + y);
+                gradient_x[o][y * gridWidth + x] = gradient.x;
+                gradient_y[o][y * gridWidth + x] = gradient.y;
+            }
+        }
+
+        lattices[o] = {gradient_x[o].data(), gradient_y[o].data(), minCell_x, minCell_y, gridWidth};
+    }
+
+    // Rows are the outer loop so each row stays in cache across every octave
+    for (int y = 0; y < height; y++) {
+        float* row = map.row(y);
+
+        for (unsigned o = 0; o < octaves; o++) {
+            accumulateNoiseRow(lattices[o], sample_x, sample_y + y, width, frequencies[o], amplitudes[o], row);
+        }
+    }
+}
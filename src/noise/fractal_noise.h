@@ -0,0 +1,48 @@
+#ifndef FRACTAL_NOISE_H
+#define FRACTAL_NOISE_H
+
+#include <vector>
+
+#include "heightmap.h"
+
+struct FractalNoiseSettings
+{
+    unsigned octaves = 8;
+    // Lattice cells per sample for the first octave
+    float frequency = 0.05f;
+    // Frequency multiplier between octaves
+    float lacunarity = 2.0f;
+    // Amplitude multiplier between octaves
+    float gain = 0.5f;
+    // Amplitude of the first octave
+    float amplitude = 3.0f;
+    // Octaves are skipped once every remaining octave together adds less than this
+    float threshold = 0.01f;
+};
+
+// Fractal Brownian motion built from octaves of gradient noise. Octave amplitudes,
+// frequencies and seeds are precomputed once so sampling does no pow calls
+class FractalNoise
+{
+    public:
+        FractalNoise(unsigned seed, const FractalNoiseSettings& settings);
+
+        // Adds the noise to every sample in the map, where map sample (x, y) is the global
+        // sample (sample_x + x, sample_y + y). Lattice gradients are hashed from global
+        // lattice coordinates, so maps sharing samples produce exactly the same heights
+        void generate(Heightmap& map, int sample_x, int sample_y) const;
+
+        // Number of octaves left after the amplitude and sampling rate cut-offs
+        unsigned getActiveOctaves() const { return amplitudes.size(); }
+
+        // Largest absolute value generate can add to a sample
+        float getMaxValue() const { return maxValue; }
+
+    private:
+        std::vector<float> amplitudes;
+        std::vector<float> frequencies;
+        std::vector<unsigned> seeds;
+        float maxValue;
+};
+
+#endif
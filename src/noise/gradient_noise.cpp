@@ -0,0 +1,299 @@
+#include "gradient_noise.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define NOISE_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #define NOISE_X86 0
+#endif
+
+// GCC and Clang need the instruction set enabled per function, MSVC allows intrinsics anywhere
+#if defined(__GNUC__)
+    #define NOISE_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define NOISE_TARGET(isa)
+#endif
+
+namespace {
+
+// Per-row values which only depend on y
+struct RowSetup
+{
+    float fy0, fy1;
+    int base0, base1;
+};
+
+RowSetup setupRow(const GradientLattice& lattice, int y, float scale)
+{
+    float py = (float)y * scale;
+    float cyf = std::floor(py);
+    int cy = (int)cyf;
+
+    RowSetup row;
+    row.fy0 = py - cyf;
+    row.fy1 = row.fy0 - 1.0f;
+    row.base0 = (cy - lattice.originY) * lattice.stride - lattice.originX;
+    row.base1 = row.base0 + lattice.stride;
+    return row;
+}
+
+inline float interpolate(float a0, float a1, float w)
+{
+    // Cubic interpolation to avoid "block" shapes in the noise
+    return (a1 - a0) * (3.0f - w * 2.0f) * w * w + a0;
+}
+
+void accumulateScalar(const GradientLattice& lattice, const RowSetup& row, int x0, int begin, int count, float scale, float amplitude, float* out)
+{
+    const float* gx = lattice.gx;
+    const float* gy = lattice.gy;
+
+    for (int i = begin; i < count; i++) {
+        float px = (float)(x0 + i) * scale;
+        float cxf = std::floor(px);
+        int cx = (int)cxf;
+
+        float fx0 = px - cxf;
+        float fx1 = fx0 - 1.0f;
+
+        int i00 = row.base0 + cx;
+        int i01 = row.base1 + cx;
+
+        float n00 = fx0 * gx[i00] + row.fy0 * gy[i00];
+        float n10 = fx1 * gx[i00 + 1] + row.fy0 * gy[i00 + 1];
+        float n01 = fx0 * gx[i01] + row.fy1 * gy[i01];
+        float n11 = fx1 * gx[i01 + 1] + row.fy1 * gy[i01 + 1];
+
+        float ix0 = interpolate(n00, n10, fx0);
+        float ix1 = interpolate(n01, n11, fx0);
+
+        out[i] += amplitude * interpolate(ix0, ix1, row.fy0);
+    }
+}
+
+#if NOISE_X86
+
+NOISE_TARGET("sse4.1")
+inline __m128 interpolate4(__m128 a0, __m128 a1, __m128 w)
+{
+    __m128 t = _mm_mul_ps(_mm_sub_ps(a1, a0), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(w, _mm_set1_ps(2.0f))));
+    t = _mm_mul_ps(_mm_mul_ps(t, w), w);
+    return _mm_add_ps(t, a0);
+}
+
+NOISE_TARGET("sse4.1")
+inline __m128 dot4(__m128 fx, __m128 fy, __m128 gx, __m128 gy)
+{
+    return _mm_add_ps(_mm_mul_ps(fx, gx), _mm_mul_ps(fy, gy));
+}
+
+// SSE4.1 has no gather, so lattice gradients are loaded one lane at a time
+NOISE_TARGET("sse4.1")
+int accumulateSSE41(const GradientLattice& lattice, const RowSetup& row, int x0, int count, float scale, float amplitude, float* out)
+{
+    const float* gx = lattice.gx;
+    const float* gy = lattice.gy;
+
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vamplitude = _mm_set1_ps(amplitude);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 fy0 = _mm_set1_ps(row.fy0);
+    const __m128 fy1 = _mm_set1_ps(row.fy1);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    alignas(16) int cx[4];
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x0 + i), lanes)), vscale);
+        __m128 cxf = _mm_floor_ps(px);
+        _mm_store_si128((__m128i*)cx, _mm_cvttps_epi32(cxf));
+
+        __m128 fx0 = _mm_sub_ps(px, cxf);
+        __m128 fx1 = _mm_sub_ps(fx0, one);
+
+        const int a = row.base0 + cx[0], b = row.base0 + cx[1], c = row.base0 + cx[2], d = row.base0 + cx[3];
+        const int e = row.base1 + cx[0], f = row.base1 + cx[1], g = row.base1 + cx[2], h = row.base1 + cx[3];
+
+        __m128 n00 = dot4(fx0, fy0, _mm_setr_ps(gx[a], gx[b], gx[c], gx[d]), _mm_setr_ps(gy[a], gy[b], gy[c], gy[d]));
+        __m128 n10 = dot4(fx1, fy0, _mm_setr_ps(gx[a+1], gx[b+1], gx[c+1], gx[d+1]), _mm_setr_ps(gy[a+1], gy[b+1], gy[c+1], gy[d+1]));
+        __m128 n01 = dot4(fx0, fy1, _mm_setr_ps(gx[e], gx[f], gx[g], gx[h]), _mm_setr_ps(gy[e], gy[f], gy[g], gy[h]));
+        __m128 n11 = dot4(fx1, fy1, _mm_setr_ps(gx[e+1], gx[f+1], gx[g+1], gx[h+1]), _mm_setr_ps(gy[e+1], gy[f+1], gy[g+1], gy[h+1]));
+
+        __m128 ix0 = interpolate4(n00, n10, fx0);
+        __m128 ix1 = interpolate4(n01, n11, fx0);
+        __m128 noise = interpolate4(ix0, ix1, fy0);
+
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(vamplitude, noise)));
+    }
+
+    return i;
+}
+
+NOISE_TARGET("avx2")
+inline __m256 interpolate8(__m256 a0, __m256 a1, __m256 w)
+{
+    __m256 t = _mm256_mul_ps(_mm256_sub_ps(a1, a0), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(w, _mm256_set1_ps(2.0f))));
+    t = _mm256_mul_ps(_mm256_mul_ps(t, w), w);
+    return _mm256_add_ps(t, a0);
+}
+
+NOISE_TARGET("avx2")
+inline __m256 dot8(__m256 fx, __m256 fy, const float* gx, const float* gy, __m256i index)
+{
+    return _mm256_add_ps(
+        _mm256_mul_ps(fx, _mm256_i32gather_ps(gx, index, 4)),
+        _mm256_mul_ps(fy, _mm256_i32gather_ps(gy, index, 4))
+    );
+}
+
+NOISE_TARGET("avx2")
+int accumulateAVX2(const GradientLattice& lattice, const RowSetup& row, int x0, int count, float scale, float amplitude, float* out)
+{
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 vamplitude = _mm256_set1_ps(amplitude);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 fy0 = _mm256_set1_ps(row.fy0);
+    const __m256 fy1 = _mm256_set1_ps(row.fy1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i base0 = _mm256_set1_epi32(row.base0);
+    const __m256i base1 = _mm256_set1_epi32(row.base1);
+    const __m256i next = _mm256_set1_epi32(1);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(x0 + i), lanes)), vscale);
+        __m256 cxf = _mm256_floor_ps(px);
+        __m256i cx = _mm256_cvttps_epi32(cxf);
+
+        __m256 fx0 = _mm256_sub_ps(px, cxf);
+        __m256 fx1 = _mm256_sub_ps(fx0, one);
+
+        __m256i i00 = _mm256_add_epi32(base0, cx);
+        __m256i i01 = _mm256_add_epi32(base1, cx);
+
+        __m256 n00 = dot8(fx0, fy0, lattice.gx, lattice.gy, i00);
+        __m256 n10 = dot8(fx1, fy0, lattice.gx, lattice.gy, _mm256_add_epi32(i00, next));
+        __m256 n01 = dot8(fx0, fy1, lattice.gx, lattice.gy, i01);
+        __m256 n11 = dot8(fx1, fy1, lattice.gx, lattice.gy, _mm256_add_epi32(i01, next));
+
+        __m256 ix0 = interpolate8(n00, n10, fx0);
+        __m256 ix1 = interpolate8(n01, n11, fx0);
+        __m256 noise = interpolate8(ix0, ix1, fy0);
+
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(vamplitude, noise)));
+    }
+
+    return i;
+}
+
+#endif
+
+NoiseKernel detectNoiseKernel()
+{
+#if NOISE_X86
+    #if defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return NoiseKernel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return NoiseKernel::SSE41;
+        }
+    #elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(info, 7, 0);
+        bool avx2 = osSavesAvx && (info[1] & (1 << 5)) != 0;
+
+        if (avx2) {
+            return NoiseKernel::AVX2;
+        }
+        if (sse41) {
+            return NoiseKernel::SSE41;
+        }
+    #endif
+#endif
+    return NoiseKernel::Scalar;
+}
+
+}
+
+NoiseKernel activeNoiseKernel()
+{
+    static const NoiseKernel kernel = detectNoiseKernel();
+    return kernel;
+}
+
+bool noiseKernelSupported(NoiseKernel kernel)
+{
+    return kernel <= activeNoiseKernel();
+}
+
+const char* noiseKernelName(NoiseKernel kernel)
+{
+    switch (kernel) {
+        case NoiseKernel::AVX2: return "AVX2";
+        case NoiseKernel::SSE41: return "SSE4.1";
+        default: return "scalar";
+    }
+}
+
+vec2 randomGradient(unsigned seed, int ix, int iy)
+{
+    const unsigned w = 8 * sizeof(unsigned);
+    const unsigned s = w / 2;
+    unsigned a = ix, b = iy;
+
+    // Bunch of magic with primes to hash to a unique value
+    a ^= seed;              
+    a *= 3284157443;
+
+    b ^= seed;               
+    b ^= a << s | a >> (w - s);
+    b *= 1911520717;
+
+    a ^= b << s | b >> (w - s);
+    a *= 2048419325;
+
+    // Converts value to range [0, 2*Pi]
+    float random = a * (3.14159265 / ~(~0u >> 1)); 
+
+    // Converts the input into a unit vector
+    vec2 v;
+    v.x = sin(random);
+    v.y = cos(random);
+
+    return v;
+}
+
+void accumulateNoiseRow(const GradientLattice& lattice, int x0, int y, int count, float scale, float amplitude, float* out)
+{
+    accumulateNoiseRow(activeNoiseKernel(), lattice, x0, y, count, scale, amplitude, out);
+}
+
+void accumulateNoiseRow(NoiseKernel kernel, const GradientLattice& lattice, int x0, int y, int count, float scale, float amplitude, float* out)
+{
+    RowSetup row = setupRow(lattice, y, scale);
+    int done = 0;
+
+#if NOISE_X86
+    if (kernel == NoiseKernel::AVX2 && noiseKernelSupported(NoiseKernel::AVX2)) {
+        done = accumulateAVX2(lattice, row, x0, count, scale, amplitude, out);
+    }
+    else if (kernel >= NoiseKernel::SSE41 && noiseKernelSupported(NoiseKernel::SSE41)) {
+        done = accumulateSSE41(lattice, row, x0, count, scale, amplitude, out);
+    }
+#endif
+
+    // Remaining samples which do not fill a whole vector
+    accumulateScalar(lattice, row, x0, done, count, scale, amplitude, out);
+}
@@ -0,0 +1,40 @@
+#ifndef GRADIENT_NOISE_H
+#define GRADIENT_NOISE_H
+
+#include "maths/vec2.h"
+
+// Unit gradients at integer lattice points, stored as separate x and y planes.
+// Element 0 of each plane is the gradient at (originX, originY)
+struct GradientLattice
+{
+    const float* gx;
+    const float* gy;
+    int originX;
+    int originY;
+    int stride;
+};
+
+// Hashes a lattice point to a pseudo-random unit gradient
+vec2 randomGradient(unsigned seed, int ix, int iy);
+
+enum class NoiseKernel
+{
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+// Adds amplitude * noise(p) to out[i] for the points p = (x0 + i, y) * scale, i in [0, count).
+// The lattice must cover every cell touched by the row.
+//
+// All kernels perform the same float operations in the same order without fused
+// multiply-adds, so the SIMD kernels are bit-identical to the scalar reference
+void accumulateNoiseRow(const GradientLattice& lattice, int x0, int y, int count, float scale, float amplitude, float* out);
+void accumulateNoiseRow(NoiseKernel kernel, const GradientLattice& lattice, int x0, int y, int count, float scale, float amplitude, float* out);
+
+// Best kernel supported by the CPU, detected once at startup
+NoiseKernel activeNoiseKernel();
+bool noiseKernelSupported(NoiseKernel kernel);
+const char* noiseKernelName(NoiseKernel kernel);
+
+#endif
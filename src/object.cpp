@@ -1,12 +1,12 @@
 #include "object.h"
 #include "maths/maths.h"
-#include "vertex.h"
-#include "dependencies/stb_image.h"
+#include "mesh/mesh_cache.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <cmath>
 
-Object::Object(Shader shader, const char* modelPath)
-    :shader(shader), VAO(0)
+Object::Object(Shader shader, const char* modelPath, unsigned int texture, ThreadPool* loaderPool)
+    :VAO(0), texture(texture), shader(shader)
 {
     unsigned int VBO, EBO;
 
@@ -16,189 +16,179 @@ Object::Object(Shader shader, const char* modelPath)
 
     glBindVertexArray(VAO);
 
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-
-    loadObject(modelPath, vertices, indices);
-    numVertices = indices.size();
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int textureWidth, textureHeight, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load("models/Tree1/baked.png", &textureWidth, &textureHeight, &nrChannels, 0);
-    if (data)
-    {
-        //glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureWidth, textureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        std::cout << nrChannels << std::endl;
-        glTexImage2D(GL_TEXTURE_2D, 0, nrChannels == 4 ? GL_RGBA : GL_RGB, 
-            textureWidth, textureHeight, 0, 
-            nrChannels == 4 ? GL_RGBA : GL_RGB, 
-            GL_UNSIGNED_BYTE, data
-        );
-
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // The cooked mesh is uploaded straight from the mapped cache when it is up to date
+    CookedMesh mesh;
+    if (mesh.load(modelPath, loaderPool)) {
+        const MeshCacheHeader& header = mesh.getHeader();
+        numVertices = header.indexCount;
+        indexType = header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        bounds = mesh.getBounds();
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, mesh.getVertexBytes(), mesh.getVertexData(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexBytes(), mesh.getIndexData(), GL_STATIC_DRAW);
+
+        for (unsigned i = 0; i < header.attributeCount; i++) {
+            const MeshAttribute& attribute = header.attributes[i];
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type, GL_FALSE,
+                header.vertexStride, (void*)(size_t)attribute.offset);
+            glEnableVertexAttribArray(attribute.location);
+        }
     }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
+    else {
+        numVertices = 0;
+    }
+
+    // Per-instance model matrix, one column per attribute location from 3 to 6
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(column * 4 * sizeof(float)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
     }
-    stbi_image_free(data);
 
     glBindVertexArray(0);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+
+    setInstances({mat4::identity()});
 }
 
 Object::~Object()
 {
     glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &instanceVBO);
 }
 
-void Object::loadObject(const char* modelPath, std::vector<float> &verticies, std::vector<unsigned int> &indices)
+void Object::setInstances(const std::vector<mat4>& transforms, float clusterSize)
 {
-    std::ifstream file(modelPath);
-    if (!file) {
-        std::cerr << "Failed to open OBJ file: " << modelPath << std::endl;
-        return;
+    // Instances sharing a grid cell are stored together, ordered by row and then column so
+    // that visible neighbours along x often form one contiguous range
+    struct CellInstance
+    {
+        int cellX, cellZ;
+        unsigned index;
+    };
+    std::vector<CellInstance> order(transforms.size());
+    for (size_t i = 0; i < transforms.size(); i++) {
+        order[i].index = i;
+        order[i].cellX = clusterSize > 0.0f ? (int)std::floor(transforms[i].m[3] / clusterSize) : 0;
+        order[i].cellZ = clusterSize > 0.0f ? (int)std::floor(transforms[i].m[11] / clusterSize) : 0;
+    }
+    std::stable_sort(order.begin(), order.end(), [](const CellInstance& a, const CellInstance& b) {
+        return a.cellZ != b.cellZ ? a.cellZ < b.cellZ : a.cellX < b.cellX;
+    });
+
+    // mat4 is row-major, while GL reads each attribute as a column
+    std::vector<float> columns(transforms.size() * 16);
+    for (size_t i = 0; i < order.size(); i++) {
+        const mat4& transform = transforms[order[i].index];
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) {
+                columns[i * 16 + column * 4 + row] = transform.m[row * 4 + column];
+            }
+        }
     }
 
-    std::vector<float> vertexArray;
-    std::vector<float> vertexTexCoordArray;
-    std::vector<float> vertexNormArray;
-
-    std::unordered_map<vertex, unsigned int> vertexMap;
-    int startIndex = 0;
-
-    int shapes = 0;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-
-
-        if (prefix == "mtllib") {
-            std::string mtlPath;
-            iss >> mtlPath;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, columns.size() * sizeof(float), columns.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-            std::filesystem::path objPath = modelPath;
-            std::filesystem::path mtlFullPath = objPath.parent_path() / mtlPath;
+    numInstances = transforms.size();
+    clusters.clear();
+    clusterBounds.clear();
 
-            // read stuff from mtl file
+    aabb clusterBox;
+    for (size_t i = 0; i < order.size(); i++) {
+        bool newCluster = i == 0 || order[i].cellX != order[i - 1].cellX || order[i].cellZ != order[i - 1].cellZ;
+        if (newCluster) {
+            if (i > 0) {
+                clusterBounds.add(clusterBox);
+            }
+            clusters.push_back({(unsigned)i, 0});
         }
-
-        else if (prefix == "v") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            vertexArray.push_back(x);
-            vertexArray.push_back(y);
-            vertexArray.push_back(z);
+        clusters.back().count++;
+
+        // Bounds of every corner of the model's box under the instance's transform
+        for (int corner = 0; corner < 8; corner++) {
+            vec4 local(
+                corner & 1 ? bounds.max.x : bounds.min.x,
+                corner & 2 ? bounds.max.y : bounds.min.y,
+                corner & 4 ? bounds.max.z : bounds.min.z,
+                1.0f
+            );
+            vec4 world = transforms[order[i].index] * local;
+            vec3 point(world.x, world.y, world.z);
+
+            if (newCluster && corner == 0) {
+                clusterBox = aabb(point, point);
+            }
+            clusterBox.expand(point);
         }
+    }
+    if (!order.empty()) {
+        clusterBounds.add(clusterBox);
+    }
+}
 
-        else if (prefix == "vt") {
-            float x, y;
-            iss >> x >> y;
-            vertexTexCoordArray.push_back(x);
-            vertexTexCoordArray.push_back(y);
+void Object::submit(RenderQueue& queue, const frustum& view, const vec3& eye, FrameStats& frameStats)
+{
+    clusterBounds.cull(view, visible);
+
+    // Adjacent visible clusters are adjacent in the instance buffer, so they merge into one draw
+    visibleRuns.clear();
+    float nearest = -1.0f;
+    for (size_t i = 0; i < clusters.size(); i++) {
+        if (!visible[i]) {
+            frameStats.culled++;
+            continue;
         }
+        frameStats.drawn++;
 
-        else if (prefix == "vn") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            vertexNormArray.push_back(x);
-            vertexNormArray.push_back(y);
-            vertexNormArray.push_back(z);
+        const InstanceRange& cluster = clusters[i];
+        if (!visibleRuns.empty() && visibleRuns.back().first + visibleRuns.back().count == cluster.first) {
+            visibleRuns.back().count += cluster.count;
+        }
+        else {
+            visibleRuns.push_back(cluster);
         }
 
-        else if (prefix == "f") {
-            std::vector<int> vertexIndices, textIndices, normIndices;
-            std::string faceVertex;
-
-            while (iss >> faceVertex) {
-                std::replace(faceVertex.begin(), faceVertex.end(), '/', ' ');
-                std::istringstream vertexStream(faceVertex);
-                
-                int vertIndex, texIndex, normIndex;
-                if (vertexStream >> vertIndex >> texIndex >> normIndex) {
-                    vertexIndices.push_back(vertIndex);
-                    textIndices.push_back(texIndex);
-                    normIndices.push_back(normIndex);
-                }
-            }
-
-            if (vertexIndices.size() != 3) {
-                std::cerr << "Error: You were too lazy to implement non-triangle textures lock in." << std::endl;
-                return;
-            }
-            
-            for (int i = 0; i < 3; i++) 
-            {
-                vertex vert = vertex(
-                    vertexArray[(vertexIndices[i] - 1) * 3],       vertexArray[(vertexIndices[i] - 1) * 3 + 1],        vertexArray[(vertexIndices[i] - 1) * 3 + 2],
-                    vertexTexCoordArray[(textIndices[i] - 1) * 2], vertexTexCoordArray[(textIndices[i] - 1) * 2 + 1],
-                    vertexNormArray[(normIndices[i] - 1) * 3],     vertexNormArray[(normIndices[i] - 1) * 3 + 1],      vertexNormArray[(normIndices[i] - 1) * 3 + 2]
-                );
-
-                if (vertexMap.find(vert) != vertexMap.end()) {
-                    indices.push_back(vertexMap[vert]);
-                    continue;
-                }
-
-                vertexMap[vert] = startIndex++;
-
-                verticies.push_back(vert.x);
-                verticies.push_back(vert.y);
-                verticies.push_back(vert.z);
-
-                verticies.push_back(vert.u);
-                verticies.push_back(vert.v);
-
-                verticies.push_back(vert.nx);
-                verticies.push_back(vert.ny);
-                verticies.push_back(vert.nz);
-
-                indices.push_back(vertexMap[vert]);
-            }
+        vec3 offset = clusterBounds.center(i) - eye;
+        float distance = std::sqrt(offset.dot(offset));
+        if (nearest < 0.0f || distance < nearest) {
+            nearest = distance;
         }
     }
-}
 
-void Object::drawObject()
-{
-    shader.use();
-    shader.setInt("texture1", 0);
+    if (visibleRuns.empty()) {
+        return;
+    }
 
-    mat4 model = mat4::translate(vec3(1.0f, 0.0f, 0.0f));
-    int modelLoc = glGetUniformLocation(shader.ID, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_TRUE, model.m);
+    DrawItem item;
+    item.program = shader.ID;
+    item.texture = texture;
+    item.VAO = VAO;
+    item.draw = drawVisible;
+    item.drawData = this;
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    queue.submit(item, RENDER_PASS_OPAQUE, nearest);
+}
 
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, numVertices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+void Object::drawVisible(void* data)
+{
+    Object& object = *(Object*)data;
+
+    // GL 3.3 has no base instance, so the instance attributes are pointed at each run instead
+    glBindBuffer(GL_ARRAY_BUFFER, object.instanceVBO);
+    for (const InstanceRange& run : object.visibleRuns) {
+        size_t offset = (size_t)run.first * 16 * sizeof(float);
+        for (int column = 0; column < 4; column++) {
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(offset + column * 4 * sizeof(float)));
+        }
+        glDrawElementsInstanced(GL_TRIANGLES, object.numVertices, object.indexType, 0, run.count);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
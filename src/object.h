@@ -2,25 +2,62 @@
 #define OBJECT_H
 
 #include "shaders/shader.h"
+#include "maths/maths.h"
+#include "render_queue.h"
+#include "culling.h"
+#include "jobs/thread_pool.h"
 
 #include <vector>
 
 class Object
 {
     public:
-        Object(Shader shader, const char* modelPath);
+        // The texture is owned by the caller, normally a TextureManager. A model which has
+        // to be cooked is parsed on the pool when one is given
+        Object(Shader shader, const char* modelPath, unsigned int texture, ThreadPool* loaderPool = nullptr);
         ~Object();
 
-        void loadObject(const char* modelPath, std::vector<float> &vertices, std::vector<unsigned int> &indices);
-        void drawObject();
+        // Culls the instance clusters against the frustum and queues the visible ones as one
+        // item, drawing each run of adjacent visible clusters with a single instanced draw.
+        // The object must outlive the queue's next flush
+        void submit(RenderQueue& queue, const frustum& view, const vec3& eye, FrameStats& frameStats);
+
+        // Replaces the per-instance model matrices, grouping them into clusters on a grid of
+        // clusterSize squares in x and z so each cluster is culled on its own. A size of 0
+        // keeps every instance in one cluster. The object starts with one identity instance
+        void setInstances(const std::vector<mat4>& transforms, float clusterSize = 0.0f);
+        unsigned getInstanceCount() const { return numInstances; }
 
         unsigned int VAO;
         unsigned int texture = -1;
         Shader shader;
         int numVertices = -1;
+        unsigned int indexType = GL_UNSIGNED_INT;
 
     private:
-        
+        // A range of the instance buffer
+        struct InstanceRange
+        {
+            unsigned first;
+            unsigned count;
+        };
+
+        // Render queue callback, given the object
+        static void drawVisible(void* object);
+
+        // Model space bounds of the loaded vertices
+        aabb bounds;
+
+        unsigned int instanceVBO = 0;
+        unsigned numInstances = 0;
+
+        // Instances are stored cluster by cluster, with the world space bounds of each
+        std::vector<InstanceRange> clusters;
+        BoundsBatch clusterBounds;
+
+        // Reused every frame for culling
+        std::vector<unsigned char> visible;
+        std::vector<InstanceRange> visibleRuns;
 };  
 
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "render_queue.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+// Least significant digit radix sort over the 8 bytes of the key. A byte which is the same
+// for every entry, such as the pass in most frames, leaves the order unchanged and is skipped
+void RenderQueue::radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+    const unsigned count = entries.size();
+    scratch.resize(count);
+
+    unsigned histograms[8][256] = {};
+    for (const auto& entry : entries) {
+        for (int byte = 0; byte < 8; byte++) {
+            histograms[byte][(entry.key >> (byte * 8)) & 0xFF]++;
+        }
+    }
+
+    for (int byte = 0; byte < 8; byte++) {
+        unsigned* histogram = histograms[byte];
+        if (histogram[(entries[0].key >> (byte * 8)) & 0xFF] == count) {
+            continue;
+        }
+
+        unsigned offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            unsigned digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (const auto& entry : entries) {
+            scratch[histogram[(entry.key >> (byte * 8)) & 0xFF]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+RenderQueue::RenderQueue(float maxDepth)
+    :maxDepth(maxDepth)
+{
+
+}
+
+uint64_t RenderQueue::makeKey(const DrawItem& item, RenderPass pass, float depth) const
+{
+    // Object names only group draws, so names too large for their field wrapping onto
+    // others costs at most an extra bind and never a wrong one
+    float range = std::min(std::max(depth / maxDepth, 0.0f), 1.0f);
+    uint64_t quantised = (uint64_t)(range * 0xFFFFF);
+    if (pass == RENDER_PASS_TRANSPARENT) {
+        quantised = 0xFFFFF - quantised;
+    }
+
+    return ((uint64_t)(pass & 0xF) << 60)
+        | ((uint64_t)(item.program & 0xFFF) << 48)
+        | ((uint64_t)(item.texture & 0xFFF) << 36)
+        | ((uint64_t)(item.VAO & 0xFFFF) << 20)
+        | quantised;
+}
+
+void RenderQueue::submit(const DrawItem& item, RenderPass pass, float depth)
+{
+    entries.push_back({makeKey(item, pass, depth), (unsigned)items.size()});
+    items.push_back(item);
+}
+
+unsigned RenderQueue::BoundState::bind(const DrawItem& item, bool issue)
+{
+    unsigned changes = 0;
+
+    if (item.program != program) {
+        if (issue) {
+            glUseProgram(item.program);
+        }
+        program = item.program;
+        changes++;
+    }
+    if (item.texture != 0 && item.texture != texture) {
+        if (issue) {
+            glBindTexture(GL_TEXTURE_2D, item.texture);
+        }
+        texture = item.texture;
+        changes++;
+    }
+    if (item.VAO != VAO) {
+        if (issue) {
+            glBindVertexArray(item.VAO);
+        }
+        VAO = item.VAO;
+        // The element buffer binding belongs to the VAO
+        EBO = unknown;
+        changes++;
+    }
+    if (item.EBO != 0 && item.EBO != EBO) {
+        if (issue) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, item.EBO);
+        }
+        EBO = item.EBO;
+        changes++;
+    }
+
+    return changes;
+}
+
+void RenderQueue::flush()
+{
+    stats = RenderStats();
+    if (items.empty()) {
+        return;
+    }
+
+    BoundState submitted;
+    for (const auto& item : items) {
+        stats.unsortedStateChanges += submitted.bind(item, false);
+    }
+
+    radixSort(entries, scratch);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    BoundState bound;
+    for (const auto& entry : entries) {
+        const DrawItem& item = items[entry.index];
+        stats.stateChanges += bound.bind(item, true);
+
+        if (item.draw) {
+            item.draw(item.drawData);
+        }
+        else if (item.instances == 1) {
+            glDrawElements(GL_TRIANGLES, item.count, item.indexType, 0);
+        }
+        else {
+            glDrawElementsInstanced(GL_TRIANGLES, item.count, item.indexType, 0, item.instances);
+        }
+        stats.draws++;
+    }
+
+    glBindVertexArray(0);
+
+    items.clear();
+    entries.clear();
+}
@@ -0,0 +1,96 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+
+// Passes are drawn in order. Opaque items are sorted front to back within each state
+// group so early depth testing can reject hidden fragments, transparent ones back to front
+enum RenderPass : unsigned
+{
+    RENDER_PASS_OPAQUE = 0,
+    RENDER_PASS_TRANSPARENT = 1
+};
+
+// One draw call and the state it needs. Zero means none for texture and EBO, in which
+// case no texture is bound and the element buffer recorded in the VAO is used
+struct DrawItem
+{
+    unsigned int program = 0;
+    unsigned int texture = 0;
+    unsigned int VAO = 0;
+    unsigned int EBO = 0;
+
+    int count = 0;
+    unsigned int indexType = 0;
+    unsigned instances = 1;
+
+    // Replaces the element draw for items which draw a batch themselves, called once the
+    // item's state is bound. The counts are then unused and the data must stay valid
+    // until the queue is flushed
+    void (*draw)(void* data) = nullptr;
+    void* drawData = nullptr;
+};
+
+struct RenderStats
+{
+    unsigned draws = 0;
+    // Program, texture, VAO and element buffer binds issued by the queue
+    unsigned stateChanges = 0;
+    // Binds the same items needed in the order they were submitted, counted by replaying
+    // them through the same change detection without issuing anything
+    unsigned unsortedStateChanges = 0;
+};
+
+// Collects a frame's draws, then sorts them by state so each program, texture and vertex
+// array is bound once per group rather than once per draw
+class RenderQueue
+{
+    public:
+        // Depths past maxDepth all sort as the furthest
+        RenderQueue(float maxDepth);
+
+        void submit(const DrawItem& item, RenderPass pass, float depth);
+        // Sorts and draws everything submitted since the last flush, then empties the queue.
+        // Must be called on the render thread
+        void flush();
+
+        const RenderStats& getStats() const { return stats; }
+
+    private:
+        struct SortEntry
+        {
+            uint64_t key;
+            unsigned index;
+        };
+
+        // What the queue last bound, so only binds which change it are made
+        struct BoundState
+        {
+            // Nothing bound by other code between flushes can be assumed
+            static constexpr unsigned int unknown = ~0u;
+            unsigned int program = unknown;
+            unsigned int texture = unknown;
+            unsigned int VAO = unknown;
+            unsigned int EBO = unknown;
+
+            // Returns the number of binds the item needs, making them when issue is set
+            unsigned bind(const DrawItem& item, bool issue);
+        };
+
+        static void radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+        // 4 bits pass, 12 program, 12 texture, 16 VAO and 20 depth, most significant first
+        uint64_t makeKey(const DrawItem& item, RenderPass pass, float depth) const;
+
+        float maxDepth;
+
+        std::vector<DrawItem> items;
+        std::vector<SortEntry> entries;
+        std::vector<SortEntry> scratch;
+
+        RenderStats stats;
+};
+
+#endif
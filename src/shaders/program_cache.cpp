@@ -0,0 +1,169 @@
+#include "program_cache.h"
+#include "cache_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// From ARB_get_program_binary, core in GL 4.1 but not part of the GL 3.3 loader
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+typedef void (APIENTRYP PFNGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+
+namespace {
+
+const char* const programCacheDirectory = "shader_cache";
+const char programCacheMagic[4] = {'O', 'W', 'P', 'B'};
+const uint32_t programCacheVersion = 1;
+
+struct ProgramCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t length;
+};
+
+struct ProgramBinaryFunctions
+{
+    PFNGETPROGRAMBINARY getProgramBinary = nullptr;
+    PFNPROGRAMBINARY programBinary = nullptr;
+    PFNPROGRAMPARAMETERI programParameteri = nullptr;
+    bool supported = false;
+};
+
+// Resolved on first use, once a context is current
+const ProgramBinaryFunctions& programBinaryFunctions()
+{
+    static ProgramBinaryFunctions functions = [] {
+        ProgramBinaryFunctions loaded;
+        loaded.getProgramBinary = (PFNGETPROGRAMBINARY)glfwGetProcAddress("glGetProgramBinary");
+        loaded.programBinary = (PFNPROGRAMBINARY)glfwGetProcAddress("glProgramBinary");
+        loaded.programParameteri = (PFNPROGRAMPARAMETERI)glfwGetProcAddress("glProgramParameteri");
+
+        // Some drivers expose the entry points but support no binary formats at all
+        int formats = 0;
+        if (loaded.getProgramBinary && loaded.programBinary && loaded.programParameteri) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        loaded.supported = formats > 0;
+        return loaded;
+    }();
+    return functions;
+}
+
+uint64_t hashString(uint64_t hash, const std::string& text)
+{
+    // FNV-1a, with the length mixed in so that consecutive strings cannot run together
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001B3ull;
+    }
+    return (hash ^ text.size()) * 0x100000001B3ull;
+}
+
+std::string glString(GLenum name)
+{
+    const char* value = (const char*)glGetString(name);
+    return value ? value : "";
+}
+
+std::string cachePath(const std::string& key)
+{
+    return std::string(programCacheDirectory) + "/" + key + ".bin";
+}
+
+}
+
+std::string programCacheKey(const std::string& vertexCode, const std::string& fragmentCode, const std::string& defines)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = hashString(hash, vertexCode);
+    hash = hashString(hash, fragmentCode);
+    hash = hashString(hash, defines);
+    hash = hashString(hash, glString(GL_VENDOR));
+    hash = hashString(hash, glString(GL_RENDERER));
+    hash = hashString(hash, glString(GL_VERSION));
+
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+    return key;
+}
+
+bool loadProgramBinary(const std::string& key, unsigned int program)
+{
+    const ProgramBinaryFunctions& functions = programBinaryFunctions();
+    if (!functions.supported) {
+        return false;
+    }
+
+    std::ifstream file(cachePath(key), std::ios::binary);
+    ProgramCacheHeader header;
+    if (!file.read((char*)&header, sizeof(header)) ||
+        std::memcmp(header.magic, programCacheMagic, sizeof(programCacheMagic)) != 0 ||
+        header.version != programCacheVersion) {
+        return false;
+    }
+
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) {
+        return false;
+    }
+
+    // A driver update can reject old binaries even when the version string is unchanged
+    functions.programBinary(program, header.binaryFormat, binary.data(), binary.size());
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success != 0;
+}
+
+void prepareProgramBinary(unsigned int program)
+{
+    const ProgramBinaryFunctions& functions = programBinaryFunctions();
+    if (functions.supported) {
+        functions.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void storeProgramBinary(const std::string& key, unsigned int program)
+{
+    const ProgramBinaryFunctions& functions = programBinaryFunctions();
+    if (!functions.supported) {
+        return;
+    }
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    ProgramCacheHeader header;
+    std::memcpy(header.magic, programCacheMagic, sizeof(programCacheMagic));
+    header.version = programCacheVersion;
+
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    functions.getProgramBinary(program, length, &written, &format, binary.data());
+    header.binaryFormat = format;
+    header.length = written;
+
+    std::error_code error;
+    std::filesystem::create_directories(programCacheDirectory, error);
+
+    std::string path = cachePath(key);
+    if (!writeFileAtomically(path, {{&header, sizeof(header)}, {binary.data(), (size_t)written}})) {
+        std::cout << "Warning: could not write program cache " << path << std::endl;
+    }
+}
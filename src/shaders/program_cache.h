@@ -0,0 +1,22 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <string>
+
+// Linked programs are cached on disk with glGetProgramBinary, so later launches skip
+// compiling and linking. Binaries only work on the driver that produced them, so the
+// key covers the sources, the defines and the vendor, renderer and version strings.
+// Every function quietly does nothing when the driver cannot retrieve program binaries
+
+// Key for a program built from the given sources. Needs a current GL context
+std::string programCacheKey(const std::string& vertexCode, const std::string& fragmentCode, const std::string& defines);
+
+// Loads the cached binary into program, returning false if there is none or the driver
+// rejects it, in which case the program has to be compiled as usual
+bool loadProgramBinary(const std::string& key, unsigned int program);
+
+// Must be called before linking a program that will be stored
+void prepareProgramBinary(unsigned int program);
+void storeProgramBinary(const std::string& key, unsigned int program);
+
+#endif
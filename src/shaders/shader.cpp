@@ -1,6 +1,10 @@
 #include "shader.h"
+#include "program_cache.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+#include <algorithm>
+#include <cstring>
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines)
 {
     // 1. retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
@@ -30,6 +34,17 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
     }
+    vertexCode = injectDefines(vertexCode, defines);
+    fragmentCode = injectDefines(fragmentCode, defines);
+
+    // a binary from an earlier run skips compiling and linking entirely
+    ID = glCreateProgram();
+    std::string cacheKey = programCacheKey(vertexCode, fragmentCode, defines);
+    if (loadProgramBinary(cacheKey, ID)) {
+        reflectUniforms();
+        return;
+    }
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
@@ -60,9 +75,9 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     }
 
     // shader Program
-    ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
+    prepareProgramBinary(ID);
     glLinkProgram(ID);
     // print linking errors if any
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
@@ -71,12 +86,108 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
         glGetProgramInfoLog(ID, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
     }
+    else
+    {
+        storeProgramBinary(cacheKey, ID);
+    }
     
     // delete the shaders as they're linked into our program now and no longer necessary
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    reflectUniforms();
 };
 
+std::string Shader::injectDefines(const std::string& code, const std::string& defines)
+{
+    // #version has to stay the first line, so the defines go straight after it
+    if (defines.empty()) {
+        return code;
+    }
+    size_t lineEnd = code.find('\n');
+    if (code.compare(0, 8, "#version") != 0 || lineEnd == std::string::npos) {
+        return defines + "\n" + code;
+    }
+    return code.substr(0, lineEnd + 1) + defines + "\n" + code.substr(lineEnd + 1);
+}
+
+void Shader::reflectUniforms()
+{
+    uniforms = std::make_shared<std::vector<ShaderUniform>>();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength + 1);
+
+    for (int i = 0; i < count; i++) {
+        ShaderUniform uniform;
+        GLsizei length = 0;
+        glGetActiveUniform(ID, i, name.size(), &length, &uniform.size, &uniform.type, name.data());
+        uniform.name.assign(name.data(), length);
+        uniform.location = glGetUniformLocation(ID, uniform.name.c_str());
+
+        // members of uniform blocks have no location and are set through their buffer
+        if (uniform.location < 0) {
+            continue;
+        }
+
+        // arrays are reported as "name[0]" and stored without the suffix
+        size_t bracket = uniform.name.find('[');
+        if (bracket != std::string::npos) {
+            uniform.name.erase(bracket);
+        }
+        uniforms->push_back(uniform);
+    }
+
+    std::sort(uniforms->begin(), uniforms->end(), [](const ShaderUniform& a, const ShaderUniform& b) {
+        return a.name < b.name;
+    });
+}
+
+bool Shader::bindUniformBlock(const char* name, unsigned int binding) const
+{
+    unsigned int block = glGetUniformBlockIndex(ID, name);
+    if (block == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(ID, block, binding);
+    return true;
+}
+
+int Shader::getUniform(const std::string &name) const
+{
+    std::string key = name;
+    if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0) {
+        key.erase(key.size() - 3);
+    }
+
+    auto found = std::lower_bound(uniforms->begin(), uniforms->end(), key, [](const ShaderUniform& uniform, const std::string& key) {
+        return uniform.name < key;
+    });
+    if (found == uniforms->end() || found->name != key) {
+        return -1;
+    }
+    return found - uniforms->begin();
+}
+
+bool Shader::updateValue(int uniform, const void* data, size_t bytes) const
+{
+    if (uniform < 0) {
+        return false;
+    }
+
+    ShaderUniform& entry = (*uniforms)[uniform];
+    if (entry.hasValue && entry.value.size() == bytes && std::memcmp(entry.value.data(), data, bytes) == 0) {
+        return false;
+    }
+
+    const unsigned char* bytesData = (const unsigned char*)data;
+    entry.value.assign(bytesData, bytesData + bytes);
+    entry.hasValue = true;
+    return true;
+}
+
 void Shader::use() 
 { 
     glUseProgram(ID);
@@ -84,19 +195,103 @@ void Shader::use()
 
 void Shader::setBool(const std::string &name, bool value) const
 {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    setInt(getUniform(name), (int)value); 
 }
 
 void Shader::setInt(const std::string &name, int value) const
 { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    setInt(getUniform(name), value); 
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    setFloat(getUniform(name), value); 
 } 
 
+void Shader::setVec2(const std::string &name, const vec2 &value) const
+{
+    setVec2(getUniform(name), value);
+}
+
+void Shader::setVec3(const std::string &name, const vec3 &value) const
+{
+    setVec3(getUniform(name), value);
+}
+
+void Shader::setMat4(const std::string &name, const mat4 &value) const
+{
+    setMat4(getUniform(name), value);
+}
+
+void Shader::setInt(int uniform, int value) const
+{
+    if (updateValue(uniform, &value, sizeof(value))) {
+        glUniform1i((*uniforms)[uniform].location, value);
+    }
+}
+
+void Shader::setFloat(int uniform, float value) const
+{
+    if (updateValue(uniform, &value, sizeof(value))) {
+        glUniform1f((*uniforms)[uniform].location, value);
+    }
+}
+
+void Shader::setVec2(int uniform, const vec2 &value) const
+{
+    const float data[2] = {value.x, value.y};
+    if (updateValue(uniform, data, sizeof(data))) {
+        glUniform2fv((*uniforms)[uniform].location, 1, data);
+    }
+}
+
+void Shader::setVec3(int uniform, const vec3 &value) const
+{
+    const float data[3] = {value.x, value.y, value.z};
+    if (updateValue(uniform, data, sizeof(data))) {
+        glUniform3fv((*uniforms)[uniform].location, 1, data);
+    }
+}
+
+void Shader::setMat4(int uniform, const mat4 &value) const
+{
+    // mat4 is row-major, so the matrix is transposed on upload
+    if (updateValue(uniform, value.m, sizeof(value.m))) {
+        glUniformMatrix4fv((*uniforms)[uniform].location, 1, GL_TRUE, value.m);
+    }
+}
+
+void Shader::setFloatArray(int uniform, const float* values, int count) const
+{
+    if (updateValue(uniform, values, count * sizeof(float))) {
+        glUniform1fv((*uniforms)[uniform].location, count, values);
+    }
+}
+
+void Shader::setVec3Array(int uniform, const vec3* values, int count) const
+{
+    std::vector<float> data(count * 3);
+    for (int i = 0; i < count; i++) {
+        data[i * 3] = values[i].x;
+        data[i * 3 + 1] = values[i].y;
+        data[i * 3 + 2] = values[i].z;
+    }
+    if (updateValue(uniform, data.data(), data.size() * sizeof(float))) {
+        glUniform3fv((*uniforms)[uniform].location, count, data.data());
+    }
+}
+
+void Shader::setMat4Array(int uniform, const mat4* values, int count) const
+{
+    std::vector<float> data(count * 16);
+    for (int i = 0; i < count; i++) {
+        std::copy(values[i].m, values[i].m + 16, data.begin() + i * 16);
+    }
+    if (updateValue(uniform, data.data(), data.size() * sizeof(float))) {
+        glUniformMatrix4fv((*uniforms)[uniform].location, count, GL_TRUE, data.data());
+    }
+}
+
 void Shader::deleteShader()
 {
     glDeleteProgram(ID);
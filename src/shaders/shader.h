@@ -7,6 +7,23 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <memory>
+#include <vector>
+
+#include "maths/maths.h"
+
+// an active uniform found when the program was linked, with the last value uploaded to it
+struct ShaderUniform
+{
+    std::string name;
+    int location;
+    GLenum type;
+    // number of array elements, 1 for plain uniforms
+    int size;
+
+    std::vector<unsigned char> value;
+    bool hasValue = false;
+};
   
 class Shader
 {
@@ -14,16 +31,50 @@ public:
     // the program ID
     unsigned int ID;
   
-    // constructor reads and builds the shader
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // constructor reads and builds the shader, inserting the defines after the #version
+    // line of both stages. Linked programs are cached on disk when the driver allows it
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = "");
     // use/activate the shader
     void use();
-    // utility uniform functions
+
+    // points the named uniform block at a uniform buffer binding, returning false if the
+    // program has no such block
+    bool bindUniformBlock(const char* name, unsigned int binding) const;
+
+    // handle of an active uniform, or -1 if the program has no such uniform. Arrays can
+    // be found by either "name" or "name[0]"
+    int getUniform(const std::string &name) const;
+
+    // utility uniform functions. The shader must be in use, and a value equal to the last
+    // one set is not uploaded again, so uniforms should only be changed through these
     void setBool(const std::string &name, bool value) const;  
     void setInt(const std::string &name, int value) const;   
     void setFloat(const std::string &name, float value) const;
+    void setVec2(const std::string &name, const vec2 &value) const;
+    void setVec3(const std::string &name, const vec3 &value) const;
+    void setMat4(const std::string &name, const mat4 &value) const;
+
+    // the same setters taking a handle from getUniform, which skip the name lookup
+    void setInt(int uniform, int value) const;
+    void setFloat(int uniform, float value) const;
+    void setVec2(int uniform, const vec2 &value) const;
+    void setVec3(int uniform, const vec3 &value) const;
+    void setMat4(int uniform, const mat4 &value) const;
+    void setFloatArray(int uniform, const float* values, int count) const;
+    void setVec3Array(int uniform, const vec3* values, int count) const;
+    void setMat4Array(int uniform, const mat4* values, int count) const;
 
     void deleteShader();
+
+private:
+    void reflectUniforms();
+    static std::string injectDefines(const std::string& code, const std::string& defines);
+    // records the value, returning false if it matches what the uniform already holds
+    bool updateValue(int uniform, const void* data, size_t bytes) const;
+
+    // shared between copies of the shader, which all refer to the same program.
+    // Sorted by name
+    std::shared_ptr<std::vector<ShaderUniform>> uniforms;
 };
   
 #endif
\ No newline at end of file
@@ -4,19 +4,25 @@ out vec4 FragColor;
 in vec3 Normal;  
 in vec3 FragPos;  
 
-uniform vec3 lightPos; 
-uniform vec3 lightColor;
+layout (std140, row_major) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 uniform vec3 objectColor;
 
 void main()
 {   
     float ambientStrength = 0.3;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = ambientStrength * lightColor.rgb;
 
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * lightColor.rgb;
             
     vec3 result = (ambient + diffuse) * objectColor;
     FragColor = vec4(result, 1.0);
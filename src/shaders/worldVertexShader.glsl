@@ -1,18 +1,45 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec2 aNormal;
+layout (location = 1) in float aHeight;
+// Per chunk, selected by the draw's base instance: origin x and z, then vertices per grid
+// row and the chunk's first vertex in the shared vertex buffer
+layout (location = 2) in vec2 aChunkOrigin;
+layout (location = 3) in ivec2 aChunkGrid;
 
 out vec3 FragPos;
 out vec3 Normal;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140, row_major) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Height of a packed value of 0 and the range covered by the 16 bits
+uniform vec2 heightRange;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = aNormal;
+    // The grid position comes from the vertex's index within the row-major chunk grid.
+    // gl_VertexID includes the draw's base vertex, which is where the chunk starts
+    int gridWidth = aChunkGrid.x;
+    int vertex = gl_VertexID - aChunkGrid.y;
+    vec2 grid = vec2(vertex % gridWidth, vertex / gridWidth);
+    float height = heightRange.x + aHeight * heightRange.y;
+
+    FragPos = vec3(aChunkOrigin.x + grid.x, height, aChunkOrigin.y + grid.y);
+    Normal = decodeOctahedral(aNormal);
 
-    gl_Position = projection * view * model * vec4(FragPos, 1.0);
-}
\ No newline at end of file
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,220 @@
+#include "terrain_buffers.h"
+#include "gl_extensions.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// From ARB_draw_indirect and ARB_multi_draw_indirect, which the GL 3.3 core loader does not define
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+
+typedef void (APIENTRYP PFNMULTIDRAWELEMENTSINDIRECT)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+static PFNMULTIDRAWELEMENTSINDIRECT multiDrawElementsIndirect = nullptr;
+
+TerrainBuffers::TerrainBuffers(unsigned initialVertices)
+    :capacity(std::max(initialVertices, 1u))
+{
+
+}
+
+void TerrainBuffers::create()
+{
+    // Base instances in indirect commands come from ARB_base_instance, which carries the
+    // per-chunk attribute, so both are needed before GL 4.3
+    multiDrawIndirect = hasGLVersion(4, 3) ||
+        (hasGLExtension("GL_ARB_multi_draw_indirect") && (hasGLVersion(4, 2) || hasGLExtension("GL_ARB_base_instance")));
+    if (multiDrawIndirect) {
+        multiDrawElementsIndirect = (PFNMULTIDRAWELEMENTSINDIRECT)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        multiDrawIndirect = multiDrawElementsIndirect != nullptr;
+    }
+    std::cout << "Terrain draws: " << (multiDrawIndirect ? "multi-draw indirect" : "one call per chunk") << std::endl;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &drawDataBuffer);
+    if (multiDrawIndirect) {
+        glGenBuffers(1, &indirectBuffer);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(TerrainVertex), nullptr, GL_STATIC_DRAW);
+    freeRanges[0] = capacity;
+
+    setVertexAttributes();
+}
+
+void TerrainBuffers::setVertexAttributes()
+{
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, normal));
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, height));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, drawDataBuffer);
+    pointDrawData(0);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TerrainBuffers::pointDrawData(unsigned entry)
+{
+    size_t offset = entry * sizeof(TerrainDrawData);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TerrainDrawData), (void*)(offset + offsetof(TerrainDrawData, originX)));
+    glVertexAttribIPointer(3, 2, GL_INT, sizeof(TerrainDrawData), (void*)(offset + offsetof(TerrainDrawData, gridWidth)));
+}
+
+void TerrainBuffers::grow(unsigned minCapacity)
+{
+    unsigned newCapacity = std::max(capacity * 2, minCapacity);
+
+    unsigned int newVBO;
+    glGenBuffers(1, &newVBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * sizeof(TerrainVertex), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, capacity * sizeof(TerrainVertex));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &VBO);
+    VBO = newVBO;
+
+    free(capacity, newCapacity - capacity);
+    capacity = newCapacity;
+
+    setVertexAttributes();
+}
+
+unsigned TerrainBuffers::allocate(const std::vector<TerrainVertex>& vertices)
+{
+    if (!VAO) {
+        create();
+    }
+
+    const unsigned count = vertices.size();
+
+    // First fit. Chunks are all the same size, so a freed chunk is an exact fit for the next
+    auto range = std::find_if(freeRanges.begin(), freeRanges.end(), [count](const std::pair<const unsigned, unsigned>& free) {
+        return free.second >= count;
+    });
+    if (range == freeRanges.end()) {
+        // Space freed at the end of the buffer joins the new space, so only the rest is needed
+        unsigned tail = 0;
+        if (!freeRanges.empty()) {
+            auto last = std::prev(freeRanges.end());
+            if (last->first + last->second == capacity) {
+                tail = last->second;
+            }
+        }
+        grow(capacity + count - tail);
+        range = std::prev(freeRanges.end());
+    }
+
+    unsigned firstVertex = range->first;
+    unsigned remaining = range->second - count;
+    freeRanges.erase(range);
+    if (remaining > 0) {
+        freeRanges[firstVertex + count] = remaining;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, firstVertex * sizeof(TerrainVertex), count * sizeof(TerrainVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return firstVertex;
+}
+
+void TerrainBuffers::free(unsigned firstVertex, unsigned count)
+{
+    // Merges with the free ranges on either side
+    auto next = freeRanges.lower_bound(firstVertex);
+    if (next != freeRanges.end() && firstVertex + count == next->first) {
+        count += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == firstVertex) {
+            previous->second += count;
+            return;
+        }
+    }
+    freeRanges[firstVertex] = count;
+}
+
+void TerrainBuffers::clearDraws()
+{
+    commands.clear();
+    drawData.clear();
+}
+
+void TerrainBuffers::addDraw(const vec3& origin, unsigned gridWidth, unsigned firstVertex, const TerrainIndexRange& indices)
+{
+    DrawElementsIndirectCommand command;
+    command.count = indices.count;
+    command.instanceCount = 1;
+    command.firstIndex = indices.firstIndex;
+    command.baseVertex = firstVertex;
+    command.baseInstance = commands.size();
+    commands.push_back(command);
+
+    drawData.push_back({origin.x, origin.z, (int32_t)gridWidth, (int32_t)firstVertex});
+}
+
+void TerrainBuffers::draw(unsigned int indexType, unsigned indexSize)
+{
+    lastDrawCalls = 0;
+    if (commands.empty()) {
+        return;
+    }
+
+    // Orphaned every frame so the driver never waits for the previous frame's draws
+    glBindBuffer(GL_ARRAY_BUFFER, drawDataBuffer);
+    glBufferData(GL_ARRAY_BUFFER, drawData.size() * sizeof(TerrainDrawData), drawData.data(), GL_STREAM_DRAW);
+
+    if (multiDrawIndirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+        multiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        lastDrawCalls = 1;
+    }
+    else {
+        // Without base instances the per-chunk attributes are pointed at each chunk's entry instead
+        for (unsigned i = 0; i < commands.size(); i++) {
+            const DrawElementsIndirectCommand& command = commands[i];
+            pointDrawData(i);
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.count, indexType,
+                (void*)((size_t)command.firstIndex * indexSize), command.baseVertex);
+        }
+        pointDrawData(0);
+        lastDrawCalls = commands.size();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TerrainBuffers::release()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &drawDataBuffer);
+    glDeleteBuffers(1, &indirectBuffer);
+
+    VAO = VBO = drawDataBuffer = indirectBuffer = 0;
+    freeRanges.clear();
+    commands.clear();
+    drawData.clear();
+}
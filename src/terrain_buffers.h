@@ -0,0 +1,86 @@
+#ifndef TERRAIN_BUFFERS_H
+#define TERRAIN_BUFFERS_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "maths/maths.h"
+#include "terrain_indices.h"
+#include "terrain_vertex.h"
+
+// Layout glMultiDrawElementsIndirect reads its commands in
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// Per-chunk values read by worldVertexShader.glsl through instanced attributes, which
+// each draw selects with its base instance. The vertex counts are integer attributes,
+// since floats stop being exact past 2^24 vertices
+struct TerrainDrawData
+{
+    float originX;
+    float originZ;
+    int32_t gridWidth;
+    // First vertex of the chunk in the shared buffer, gl_VertexID includes it
+    int32_t firstVertex;
+};
+
+// Keeps the vertices of every resident chunk in one vertex buffer behind one VAO, so the
+// visible chunks can be drawn together. With GL 4.3 or ARB_multi_draw_indirect that is a
+// single glMultiDrawElementsIndirect, on plain GL 3.3 it falls back to a loop of
+// glDrawElementsBaseVertex calls which needs no state changes between chunks
+class TerrainBuffers
+{
+    public:
+        // Space for initialVertices is allocated with the buffer, it grows when that runs out
+        TerrainBuffers(unsigned initialVertices);
+
+        // Copies the vertices into the shared buffer and returns the first one. Must be called
+        // on the render thread, as must everything else here
+        unsigned allocate(const std::vector<TerrainVertex>& vertices);
+        void free(unsigned firstVertex, unsigned count);
+
+        // Starts a new frame's list of chunks
+        void clearDraws();
+        void addDraw(const vec3& origin, unsigned gridWidth, unsigned firstVertex, const TerrainIndexRange& indices);
+        // Draws the listed chunks. The VAO and the terrain element buffer must be bound
+        void draw(unsigned int indexType, unsigned indexSize);
+
+        unsigned int getVAO() const { return VAO; }
+        unsigned numDraws() const { return commands.size(); }
+        // Number of GL draw calls the last draw made
+        unsigned drawCalls() const { return lastDrawCalls; }
+        bool usesMultiDrawIndirect() const { return multiDrawIndirect; }
+
+        void release();
+
+    private:
+        void create();
+        // Replaces the vertex buffer with one of at least the given size, keeping its contents
+        void grow(unsigned minCapacity);
+        void setVertexAttributes();
+        // Points the per-chunk attributes at one entry of the draw data buffer
+        void pointDrawData(unsigned entry);
+
+        unsigned int VAO = 0;
+        unsigned int VBO = 0;
+        unsigned int drawDataBuffer = 0;
+        unsigned int indirectBuffer = 0;
+        bool multiDrawIndirect = false;
+
+        unsigned capacity;
+        // Unused ranges of the vertex buffer, first vertex to count, with no two adjacent
+        std::map<unsigned, unsigned> freeRanges;
+
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<TerrainDrawData> drawData;
+        unsigned lastDrawCalls = 0;
+};
+
+#endif
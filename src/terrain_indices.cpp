@@ -0,0 +1,141 @@
+#include "terrain_indices.h"
+#include "mesh/mesh_optimizer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <glad/glad.h>
+
+void buildGridIndices(unsigned width, unsigned height, unsigned step, unsigned stitchMask, std::vector<unsigned int>& indices)
+{
+    indices.clear();
+    indices.reserve((width - 1) / step * ((height - 1) / step) * 6);
+
+    // Vertices on a stitched edge which the coarser neighbour does not have are collapsed
+    // onto the previous vertex along that edge. Triangles which collapse are dropped. Where
+    // two stitched edges meet this can leave a triangle with no area in x/z, which is kept
+    // as it still closes the vertical gap at the corner
+    auto snap = [&](unsigned x, unsigned z) {
+        bool onStitchedRow = (z == 0 && (stitchMask & STITCH_NEGATIVE_Z)) || (z == height - 1 && (stitchMask & STITCH_POSITIVE_Z));
+        bool onStitchedColumn = (x == 0 && (stitchMask & STITCH_NEGATIVE_X)) || (x == width - 1 && (stitchMask & STITCH_POSITIVE_X));
+
+        if (onStitchedRow && x % (2 * step) != 0) {
+            x -= step;
+        }
+        else if (onStitchedColumn && z % (2 * step) != 0) {
+            z -= step;
+        }
+        return z * width + x;
+    };
+
+    auto addTriangle = [&](unsigned int a, unsigned int b, unsigned int c) {
+        if (a == b || b == c || a == c) {
+            return;
+        }
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    };
+
+    for (unsigned z = 0; z + step < height; z += step) {
+        for (unsigned x = 0; x + step < width; x += step) {
+            unsigned int top_left = snap(x, z);
+            unsigned int top_right = snap(x + step, z);
+            unsigned int bottom_left = snap(x, z + step);
+            unsigned int bottom_right = snap(x + step, z + step);
+
+            addTriangle(top_left, top_right, bottom_left);
+            addTriangle(top_right, bottom_right, bottom_left);
+        }
+    }
+}
+
+TerrainIndexBuffers::TerrainIndexBuffers(unsigned maxVertices)
+    :type(maxVertices <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT)
+{
+
+}
+
+unsigned TerrainIndexBuffers::getIndexSize() const
+{
+    return type == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+}
+
+void TerrainIndexBuffers::reserve(unsigned indexCount)
+{
+    if (used + indexCount <= capacity) {
+        return;
+    }
+
+    // Doubling keeps the copies rare, there are only a few dozen grids in total
+    unsigned newCapacity = std::max(capacity * 2, used + indexCount);
+    unsigned int newEBO;
+    glGenBuffers(1, &newEBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * getIndexSize(), nullptr, GL_STATIC_DRAW);
+
+    if (EBO) {
+        glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used * getIndexSize());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    EBO = newEBO;
+    capacity = newCapacity;
+}
+
+const TerrainIndexRange& TerrainIndexBuffers::get(unsigned width, unsigned height, unsigned step, unsigned stitchMask)
+{
+    auto key = std::make_tuple(width, height, step, stitchMask);
+    auto found = ranges.find(key);
+    if (found != ranges.end()) {
+        return found->second;
+    }
+
+    std::vector<unsigned int> indices;
+    buildGridIndices(width, height, step, stitchMask, indices);
+
+    // Row by row order evicts the previous row from the vertex cache long before the next
+    // row reuses it. Every chunk shares these indices, so reordering once pays off on
+    // every chunk drawn
+    VertexCacheStats before = analyzeVertexCache(indices, width * height);
+    optimizeVertexCache(indices, width * height);
+    VertexCacheStats after = analyzeVertexCache(indices, width * height);
+
+    if (stitchMask == 0) {
+        std::cout << "Terrain indices " << width << "x" << height << " step " << step << ": ACMR " << before.acmr
+            << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+    }
+
+    TerrainIndexRange range;
+    range.count = indices.size();
+    reserve(indices.size());
+    range.firstIndex = used;
+
+    // Filled through the copy target, as the element array binding belongs to the bound VAO
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+
+    // 16-bit indices halve the buffer whenever every vertex can be addressed with them
+    if (type == GL_UNSIGNED_SHORT) {
+        std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, used * sizeof(unsigned short), shortIndices.size() * sizeof(unsigned short), shortIndices.data());
+    }
+    else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, used * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    used += indices.size();
+
+    return ranges[key] = range;
+}
+
+void TerrainIndexBuffers::release()
+{
+    glDeleteBuffers(1, &EBO);
+    EBO = 0;
+    capacity = used = 0;
+    ranges.clear();
+}
@@ -0,0 +1,61 @@
+#ifndef TERRAIN_INDICES_H
+#define TERRAIN_INDICES_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Indices shared by every chunk mesh of the same grid size, level of detail and stitching,
+// stored as a range of the one element buffer holding all terrain indices
+struct TerrainIndexRange
+{
+    unsigned int firstIndex = 0;
+    int count = 0;
+};
+
+// Chunk edges which border a chunk one level of detail coarser
+enum StitchEdge : unsigned
+{
+    STITCH_NEGATIVE_Z = 1,
+    STITCH_POSITIVE_X = 2,
+    STITCH_POSITIVE_Z = 4,
+    STITCH_NEGATIVE_X = 8
+};
+
+// Triangle list for a row-major grid of width x height vertices which only uses every
+// step-th vertex in each direction. Along each edge in stitchMask only every second of
+// those vertices is used, matching the coarser neighbour so no cracks open between them.
+// (width - 1) and (height - 1) must be multiples of step, or 2 * step when stitched
+void buildGridIndices(unsigned width, unsigned height, unsigned step, unsigned stitchMask, std::vector<unsigned int>& indices);
+
+class TerrainIndexBuffers
+{
+    public:
+        // Every grid must have at most maxVertices vertices, which decides whether
+        // 16-bit indices are enough
+        TerrainIndexBuffers(unsigned maxVertices);
+
+        // Returns the range for the grid, building and uploading it on first use.
+        // Must be called on the render thread
+        const TerrainIndexRange& get(unsigned width, unsigned height, unsigned step = 1, unsigned stitchMask = 0);
+        void release();
+
+        // Element buffer holding every range. It is replaced when it grows, so has to be
+        // fetched again after get
+        unsigned int getEBO() const { return EBO; }
+        // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+        unsigned int getType() const { return type; }
+        unsigned getIndexSize() const;
+
+    private:
+        void reserve(unsigned indexCount);
+
+        unsigned int EBO = 0;
+        unsigned int type;
+        unsigned capacity = 0;
+        unsigned used = 0;
+
+        std::map<std::tuple<unsigned, unsigned, unsigned, unsigned>, TerrainIndexRange> ranges;
+};
+
+#endif
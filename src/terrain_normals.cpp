@@ -0,0 +1,80 @@
+#include "terrain_normals.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define NORMALS_SSE 1
+    #include <emmintrin.h>
+#else
+    #define NORMALS_SSE 0
+#endif
+
+// Columns per tile, so the three input rows of a tile stay in L1 on wide heightmaps
+static const unsigned tileWidth = 256;
+
+// Normal of the surface y = h(x, z) is (h(x-1) - h(x+1), 2 * spacing, h(z-1) - h(z+1)) normalised
+static void normalsScalar(const float* above, const float* row, const float* below, unsigned begin, unsigned end,
+    float up, float* nx, float* ny, float* nz)
+{
+    for (unsigned x = begin; x < end; x++) {
+        float dx = row[x - 1] - row[x + 1];
+        float dz = above[x] - below[x];
+
+        float inverseLength = 1.0f / std::sqrt(dx * dx + up * up + dz * dz);
+        nx[x - 1] = dx * inverseLength;
+        ny[x - 1] = up * inverseLength;
+        nz[x - 1] = dz * inverseLength;
+    }
+}
+
+#if NORMALS_SSE
+static unsigned normalsSSE(const float* above, const float* row, const float* below, unsigned begin, unsigned end,
+    float up, float* nx, float* ny, float* nz)
+{
+    const __m128 vup = _mm_set1_ps(up);
+    const __m128 upSquared = _mm_mul_ps(vup, vup);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    unsigned x = begin;
+    for (; x + 4 <= end; x += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(row + x - 1), _mm_loadu_ps(row + x + 1));
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(above + x), _mm_loadu_ps(below + x));
+
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), upSquared), _mm_mul_ps(dz, dz));
+        __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+
+        _mm_storeu_ps(nx + x - 1, _mm_mul_ps(dx, inverseLength));
+        _mm_storeu_ps(ny + x - 1, _mm_mul_ps(vup, inverseLength));
+        _mm_storeu_ps(nz + x - 1, _mm_mul_ps(dz, inverseLength));
+    }
+
+    return x;
+}
+#endif
+
+void computeTerrainNormals(const HeightmapView& heights, float spacing, float* nx, float* ny, float* nz)
+{
+    const unsigned width = heights.getWidth();
+    const unsigned height = heights.getHeight();
+    if (width < 3 || height < 3) {
+        return;
+    }
+
+    const unsigned outWidth = width - 2;
+    const float up = 2.0f * spacing;
+
+    for (unsigned tile = 1; tile < width - 1; tile += tileWidth) {
+        const unsigned tileEnd = std::min(tile + tileWidth, width - 1);
+
+        for (unsigned z = 1; z < height - 1; z++) {
+            const size_t out = (size_t)(z - 1) * outWidth;
+            unsigned x = tile;
+
+#if NORMALS_SSE
+            x = normalsSSE(heights.row(z - 1), heights.row(z), heights.row(z + 1), x, tileEnd, up, nx + out, ny + out, nz + out);
+#endif
+            normalsScalar(heights.row(z - 1), heights.row(z), heights.row(z + 1), x, tileEnd, up, nx + out, ny + out, nz + out);
+        }
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef TERRAIN_NORMALS_H
+#define TERRAIN_NORMALS_H
+
+#include "heightmap.h"
+
+// Computes a unit normal for every sample inside a one sample apron of heights, using
+// central differences between neighbouring samples spaced spacing apart. The
+// (width - 2) x (height - 2) normals are written row-major to separate x, y and z planes
+void computeTerrainNormals(const HeightmapView& heights, float spacing, float* nx, float* ny, float* nz);
+
+#endif
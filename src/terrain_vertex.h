@@ -0,0 +1,50 @@
+#ifndef TERRAIN_VERTEX_H
+#define TERRAIN_VERTEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Compact terrain vertex. x and z are implied by the vertex's place in the chunk grid
+// and are rebuilt from gl_VertexID in worldVertexShader.glsl, so only the height and an
+// octahedral-encoded normal are stored. The last two bytes keep vertices 4-byte aligned
+struct TerrainVertex
+{
+    int16_t normal[2];
+    uint16_t height;
+    uint16_t padding;
+};
+
+static_assert(sizeof(TerrainVertex) == 8, "TerrainVertex must stay tightly packed");
+
+inline int16_t packSnorm16(float value)
+{
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+// Maps a height in [minHeight, maxHeight] onto the full 16-bit range
+inline uint16_t packHeight(float height, float minHeight, float maxHeight)
+{
+    float t = (height - minHeight) / (maxHeight - minHeight);
+    return (uint16_t)std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f);
+}
+
+// Projects a unit normal onto an octahedron and unfolds it onto the [-1, 1] square
+inline void packOctahedral(float x, float y, float z, int16_t out[2])
+{
+    float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    float u = x / l1;
+    float v = y / l1;
+
+    if (z < 0.0f) {
+        float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    out[0] = packSnorm16(u);
+    out[1] = packSnorm16(v);
+}
+
+#endif
@@ -0,0 +1,384 @@
+#include "texture_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t blocksAcross(uint32_t size)
+{
+    return (size + 3) / 4;
+}
+
+size_t blockBytes(TextureFormat format)
+{
+    return format == TextureFormat::BC1 ? 8 : 16;
+}
+
+// Gathers a 4x4 block, repeating the last row and column past the edge of the image
+void loadBlock(const unsigned char* pixels, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, unsigned char block[64])
+{
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t sy = std::min(by * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t sx = std::min(bx * 4 + x, width - 1);
+            std::memcpy(block + (y * 4 + x) * 4, pixels + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+uint16_t packRgb565(const float colour[3])
+{
+    int r = (int)std::lround(std::min(std::max(colour[0], 0.0f), 255.0f) * 31.0f / 255.0f);
+    int g = (int)std::lround(std::min(std::max(colour[1], 0.0f), 255.0f) * 63.0f / 255.0f);
+    int b = (int)std::lround(std::min(std::max(colour[2], 0.0f), 255.0f) * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+void unpackRgb565(uint16_t packed, int colour[3])
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+}
+
+void writeLittleEndian(unsigned char* out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (unsigned char)(value >> (i * 8));
+    }
+}
+
+uint64_t readLittleEndian(const unsigned char* in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (i * 8);
+    }
+    return value;
+}
+
+void encodeColourBlock(const unsigned char block[64], unsigned char out[8])
+{
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            mean[c] += block[i * 4 + c] / 16.0f;
+        }
+    }
+
+    float covariance[6] = {};
+    for (int i = 0; i < 16; i++) {
+        float d[3] = {block[i * 4] - mean[0], block[i * 4 + 1] - mean[1], block[i * 4 + 2] - mean[2]};
+        covariance[0] += d[0] * d[0];
+        covariance[1] += d[0] * d[1];
+        covariance[2] += d[0] * d[2];
+        covariance[3] += d[1] * d[1];
+        covariance[4] += d[1] * d[2];
+        covariance[5] += d[2] * d[2];
+    }
+
+    // Power iteration for the principal axis, starting from the luminance direction
+    float axis[3] = {0.3f, 0.59f, 0.11f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3] = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+        };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 3; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float lowest = 0.0f, highest = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = (block[i * 4] - mean[0]) * axis[0] + (block[i * 4 + 1] - mean[1]) * axis[1] + (block[i * 4 + 2] - mean[2]) * axis[2];
+        lowest = std::min(lowest, t);
+        highest = std::max(highest, t);
+    }
+
+    // Pulling the endpoints in slightly lowers the error of the interpolated colours
+    float inset = (highest - lowest) / 16.0f;
+    lowest += inset;
+    highest -= inset;
+
+    float maxColour[3], minColour[3];
+    for (int c = 0; c < 3; c++) {
+        maxColour[c] = mean[c] + axis[c] * highest;
+        minColour[c] = mean[c] + axis[c] * lowest;
+    }
+
+    uint16_t colour0 = packRgb565(maxColour);
+    uint16_t colour1 = packRgb565(minColour);
+
+    // colour0 > colour1 selects the four colour mode
+    if (colour0 < colour1) {
+        std::swap(colour0, colour1);
+    }
+
+    uint32_t indices = 0;
+    if (colour0 != colour1) {
+        int palette[4][3];
+        unpackRgb565(colour0, palette[0]);
+        unpackRgb565(colour1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = INT32_MAX;
+            for (int p = 0; p < 4; p++) {
+                int error = 0;
+                for (int c = 0; c < 3; c++) {
+                    int d = block[i * 4 + c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    writeLittleEndian(out, colour0, 2);
+    writeLittleEndian(out + 2, colour1, 2);
+    writeLittleEndian(out + 4, indices, 4);
+}
+
+void encodeAlphaBlock(const unsigned char block[64], unsigned char out[8])
+{
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, (int)block[i * 4 + 3]);
+        alpha1 = std::min(alpha1, (int)block[i * 4 + 3]);
+    }
+
+    // alpha0 > alpha1 selects eight interpolated values
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8] = {alpha0, alpha1};
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = 256;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(block[i * 4 + 3] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    out[0] = (unsigned char)alpha0;
+    out[1] = (unsigned char)alpha1;
+    writeLittleEndian(out + 2, indices, 6);
+}
+
+void decodeColourBlock(const unsigned char in[8], unsigned char block[64])
+{
+    uint16_t colour0 = (uint16_t)readLittleEndian(in, 2);
+    uint16_t colour1 = (uint16_t)readLittleEndian(in + 2, 2);
+    uint32_t indices = (uint32_t)readLittleEndian(in + 4, 4);
+
+    int palette[4][3];
+    unpackRgb565(colour0, palette[0]);
+    unpackRgb565(colour1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        if (colour0 > colour1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int p = (indices >> (i * 2)) & 3;
+        for (int c = 0; c < 3; c++) {
+            block[i * 4 + c] = (unsigned char)palette[p][c];
+        }
+        block[i * 4 + 3] = 255;
+    }
+}
+
+void decodeAlphaBlock(const unsigned char in[8], unsigned char block[64])
+{
+    int alpha0 = in[0], alpha1 = in[1];
+    uint64_t indices = readLittleEndian(in + 2, 6);
+
+    int palette[8] = {alpha0, alpha1};
+    if (alpha0 > alpha1) {
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+        }
+    }
+    else {
+        for (int p = 1; p < 5; p++) {
+            palette[p + 1] = ((5 - p) * alpha0 + p * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        block[i * 4 + 3] = (unsigned char)palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+// Appends a level to the texture, returning where its data starts
+unsigned char* addLevel(TextureData& texture, uint32_t width, uint32_t height)
+{
+    TextureLevel level;
+    level.width = width;
+    level.height = height;
+    level.offset = texture.data.size();
+    level.size = textureLevelSize(texture.format, width, height);
+
+    texture.levels.push_back(level);
+    texture.data.resize(level.offset + level.size);
+    return texture.data.data() + level.offset;
+}
+
+}
+
+size_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    if (format == TextureFormat::RGBA8) {
+        return (size_t)width * height * 4;
+    }
+    return (size_t)blocksAcross(width) * blocksAcross(height) * blockBytes(format);
+}
+
+void buildMipChain(const unsigned char* pixels, uint32_t width, uint32_t height, TextureData& texture)
+{
+    texture.format = TextureFormat::RGBA8;
+    texture.levels.clear();
+    texture.data.clear();
+
+    // Reserve the whole chain so level pointers stay valid while the next is filled
+    size_t total = 0;
+    for (uint32_t w = width, h = height; ; w = std::max(w / 2, 1u), h = std::max(h / 2, 1u)) {
+        total += (size_t)w * h * 4;
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+    texture.data.reserve(total);
+
+    std::memcpy(addLevel(texture, width, height), pixels, (size_t)width * height * 4);
+
+    while (width > 1 || height > 1) {
+        uint32_t nextWidth = std::max(width / 2, 1u);
+        uint32_t nextHeight = std::max(height / 2, 1u);
+        unsigned char* next = addLevel(texture, nextWidth, nextHeight);
+        const unsigned char* previous = texture.levelData(texture.levels.size() - 2);
+
+        for (uint32_t y = 0; y < nextHeight; y++) {
+            uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < nextWidth; x++) {
+                uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < 4; c++) {
+                    int sum = previous[((size_t)y0 * width + x0) * 4 + c] + previous[((size_t)y0 * width + x1) * 4 + c] +
+                        previous[((size_t)y1 * width + x0) * 4 + c] + previous[((size_t)y1 * width + x1) * 4 + c];
+                    next[((size_t)y * nextWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+
+        width = nextWidth;
+        height = nextHeight;
+    }
+}
+
+TextureFormat chooseCompressedFormat(const TextureData& rgba)
+{
+    const TextureLevel& level = rgba.levels[0];
+    const unsigned char* pixels = rgba.levelData(0);
+    for (size_t i = 0; i < (size_t)level.width * level.height; i++) {
+        if (pixels[i * 4 + 3] != 255) {
+            return TextureFormat::BC3;
+        }
+    }
+    return TextureFormat::BC1;
+}
+
+void compressTexture(const TextureData& rgba, TextureFormat format, TextureData& compressed)
+{
+    compressed.format = format;
+    compressed.levels.clear();
+    compressed.data.clear();
+
+    for (size_t l = 0; l < rgba.levels.size(); l++) {
+        const TextureLevel& level = rgba.levels[l];
+        const unsigned char* pixels = rgba.levelData(l);
+        unsigned char* out = addLevel(compressed, level.width, level.height);
+
+        unsigned char block[64];
+        for (uint32_t by = 0; by < blocksAcross(level.height); by++) {
+            for (uint32_t bx = 0; bx < blocksAcross(level.width); bx++) {
+                loadBlock(pixels, level.width, level.height, bx, by, block);
+
+                if (format == TextureFormat::BC3) {
+                    encodeAlphaBlock(block, out);
+                    out += 8;
+                }
+                encodeColourBlock(block, out);
+                out += 8;
+            }
+        }
+    }
+}
+
+void decompressTexture(const TextureData& compressed, TextureData& rgba)
+{
+    rgba.format = TextureFormat::RGBA8;
+    rgba.levels.clear();
+    rgba.data.clear();
+
+    for (size_t l = 0; l < compressed.levels.size(); l++) {
+        const TextureLevel& level = compressed.levels[l];
+        const unsigned char* in = compressed.levelData(l);
+        unsigned char* pixels = addLevel(rgba, level.width, level.height);
+
+        unsigned char block[64];
+        for (uint32_t by = 0; by < blocksAcross(level.height); by++) {
+            for (uint32_t bx = 0; bx < blocksAcross(level.width); bx++) {
+                if (compressed.format == TextureFormat::BC3) {
+                    decodeColourBlock(in + 8, block);
+                    decodeAlphaBlock(in, block);
+                }
+                else {
+                    decodeColourBlock(in, block);
+                }
+                in += blockBytes(compressed.format);
+
+                for (uint32_t y = 0; y < 4 && by * 4 + y < level.height; y++) {
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < level.width; x++) {
+                        std::memcpy(pixels + ((size_t)(by * 4 + y) * level.width + bx * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+                    }
+                }
+            }
+        }
+    }
+}
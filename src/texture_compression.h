@@ -0,0 +1,51 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class TextureFormat : uint32_t
+{
+    RGBA8 = 0,
+    // 4x4 blocks of 8 bytes, opaque colour
+    BC1 = 1,
+    // 4x4 blocks of 16 bytes, colour with interpolated alpha
+    BC3 = 2
+};
+
+struct TextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    // Byte range of the level within TextureData::data
+    uint64_t offset;
+    uint64_t size;
+};
+
+// A full mip chain, level 0 first, packed back to back in one allocation
+struct TextureData
+{
+    TextureFormat format = TextureFormat::RGBA8;
+    std::vector<TextureLevel> levels;
+    std::vector<unsigned char> data;
+
+    const unsigned char* levelData(size_t level) const { return data.data() + levels[level].offset; }
+};
+
+size_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+// Box filters RGBA8 pixels down to 1x1, the same chain glGenerateMipmap would build
+void buildMipChain(const unsigned char* pixels, uint32_t width, uint32_t height, TextureData& texture);
+
+// Picks BC3 for images with any translucent pixel and BC1 for the rest
+TextureFormat chooseCompressedFormat(const TextureData& rgba);
+
+// Encodes every level of an RGBA8 texture. Endpoints are fitted along the principal
+// axis of each block's colours, which is fast and close to the quality of an exhaustive search
+void compressTexture(const TextureData& rgba, TextureFormat format, TextureData& compressed);
+
+// Decodes a block compressed texture back to RGBA8, for drivers without S3TC support
+void decompressTexture(const TextureData& compressed, TextureData& rgba);
+
+#endif
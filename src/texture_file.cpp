@@ -0,0 +1,71 @@
+#include "texture_file.h"
+#include "mesh/mapped_file.h"
+#include "cache_file.h"
+
+#include <cstring>
+
+namespace {
+
+const char textureFileMagic[4] = {'O', 'W', 'T', 'X'};
+
+}
+
+bool readTextureFile(const char* path, const char* sourcePath, TextureData& texture)
+{
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(TextureFileHeader)) {
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, textureFileMagic, sizeof(textureFileMagic)) != 0 || header.version != textureFileVersion) {
+        return false;
+    }
+
+    // Without the source the cooked texture is used as shipped
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (readSourceInfo(sourcePath, sourceSize, sourceTime) &&
+        (header.sourceSize != sourceSize || header.sourceTime != sourceTime)) {
+        return false;
+    }
+
+    size_t levelsBytes = (size_t)header.levelCount * sizeof(TextureLevel);
+    if (header.levelCount == 0 || file.size() < sizeof(header) + levelsBytes) {
+        return false;
+    }
+
+    texture.format = header.format;
+    texture.levels.resize(header.levelCount);
+    std::memcpy(texture.levels.data(), file.data() + sizeof(header), levelsBytes);
+
+    const char* data = file.data() + sizeof(header) + levelsBytes;
+    size_t dataBytes = file.size() - sizeof(header) - levelsBytes;
+    for (const TextureLevel& level : texture.levels) {
+        if (level.offset + level.size > dataBytes || level.size != textureLevelSize(header.format, level.width, level.height)) {
+            return false;
+        }
+    }
+
+    texture.data.assign(data, data + dataBytes);
+    return true;
+}
+
+bool writeTextureFile(const char* path, const char* sourcePath, const TextureData& texture)
+{
+    TextureFileHeader header = {};
+    std::memcpy(header.magic, textureFileMagic, sizeof(textureFileMagic));
+    header.version = textureFileVersion;
+    header.format = texture.format;
+    header.levelCount = texture.levels.size();
+    if (!readSourceInfo(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+
+    return writeFileAtomically(path, {
+        {&header, sizeof(header)},
+        {texture.levels.data(), texture.levels.size() * sizeof(TextureLevel)},
+        {texture.data.data(), texture.data.size()}
+    });
+}
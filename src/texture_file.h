@@ -0,0 +1,34 @@
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+#include <cstdint>
+
+#include "texture_compression.h"
+
+// Bumped whenever the file layout or the encoder changes, which invalidates every cooked texture
+constexpr uint32_t textureFileVersion = 1;
+
+// Start of a cooked texture file, KTX style: the header, then levelCount TextureLevel
+// records, then the level data they point at. Offsets are relative to the data
+struct TextureFileHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    // Size and modification time of the image the texture was cooked from
+    uint64_t sourceSize;
+    int64_t sourceTime;
+
+    TextureFormat format;
+    uint32_t levelCount;
+};
+
+// Cooked textures are stored next to their source image
+const char* const textureFileExtension = ".btex";
+
+// Reads a cooked texture, failing if it is damaged, from another version or stale
+// compared to the source image at sourcePath
+bool readTextureFile(const char* path, const char* sourcePath, TextureData& texture);
+bool writeTextureFile(const char* path, const char* sourcePath, const TextureData& texture);
+
+#endif
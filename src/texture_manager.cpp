@@ -0,0 +1,184 @@
+#include "texture_manager.h"
+#include "texture_file.h"
+#include "gl_extensions.h"
+#include "dependencies/stb_image.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+// From EXT_texture_compression_s3tc, which the GL 3.3 core loader does not define
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+
+TextureManager::TextureManager(unsigned numThreads, size_t uploadBudget, bool compress)
+    :uploadBudget(uploadBudget), compress(compress), inFlight(0), pool(numThreads)
+{
+    compressionSupported = hasGLExtension("GL_EXT_texture_compression_s3tc");
+}
+
+unsigned int TextureManager::load(const std::string& path)
+{
+    auto found = textures.find(path);
+    if (found != textures.end()) {
+        return found->second;
+    }
+
+    if (!pixelBuffers[0]) {
+        glGenBuffers(numPixelBuffers, pixelBuffers);
+    }
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Mid grey until the real image replaces it
+    const unsigned char placeholder[4] = {128, 128, 128, 255};
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    textures[path] = texture;
+    inFlight.fetch_add(1, std::memory_order_relaxed);
+
+    pool.submit([this, texture, path] {
+        DecodedImage image;
+        image.texture = texture;
+        image.path = path;
+        decode(image);
+        decoded.push(std::move(image));
+    });
+
+    return texture;
+}
+
+void TextureManager::decode(DecodedImage& image) const
+{
+    std::string cookedPath = image.path + textureFileExtension;
+    image.loaded = compress && readTextureFile(cookedPath.c_str(), image.path.c_str(), image.data);
+
+    if (!image.loaded) {
+        // The flip setting is per thread, so each worker sets its own
+        stbi_set_flip_vertically_on_load_thread(true);
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(image.path.c_str(), &width, &height, &channels, 4);
+        if (!pixels) {
+            return;
+        }
+
+        buildMipChain(pixels, width, height, image.data);
+        stbi_image_free(pixels);
+
+        if (compress) {
+            TextureData rgba = std::move(image.data);
+            compressTexture(rgba, chooseCompressedFormat(rgba), image.data);
+            if (!writeTextureFile(cookedPath.c_str(), image.path.c_str(), image.data)) {
+                std::cout << "Warning: could not write cooked texture " << cookedPath << std::endl;
+            }
+        }
+        image.loaded = true;
+    }
+
+    if (image.data.format != TextureFormat::RGBA8 && !compressionSupported) {
+        TextureData compressed = std::move(image.data);
+        decompressTexture(compressed, image.data);
+    }
+}
+
+void TextureManager::update()
+{
+    DecodedImage image;
+    while (decoded.pop(image)) {
+        inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+        if (!image.loaded) {
+            std::cout << "Failed to load texture: " << image.path << std::endl;
+            continue;
+        }
+        uploads.push_back(std::move(image));
+    }
+
+    size_t uploaded = 0;
+    while (!uploads.empty()) {
+        DecodedImage& next = uploads.front();
+        size_t bytes = next.data.data.size();
+        if (uploaded > 0 && uploaded + bytes > uploadBudget) {
+            break;
+        }
+
+        upload(next);
+        uploaded += bytes;
+        uploads.pop_front();
+    }
+}
+
+void TextureManager::upload(DecodedImage& image)
+{
+    const TextureData& data = image.data;
+    size_t bytes = data.data.size();
+
+    // Orphaning the buffer before mapping it means the copy never waits on an earlier upload
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[nextPixelBuffer]);
+    nextPixelBuffer = (nextPixelBuffer + 1) % numPixelBuffers;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    // Client memory when the buffer could not be mapped, otherwise levels are read from the bound PBO
+    const unsigned char* source = nullptr;
+    if (mapped) {
+        std::memcpy(mapped, data.data.data(), bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else {
+        // Fall back on a plain client memory upload
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        source = data.data.data();
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, image.texture);
+
+    // Every level comes precomputed, so there is no mipmap generation at runtime
+    for (size_t l = 0; l < data.levels.size(); l++) {
+        const TextureLevel& level = data.levels[l];
+        // With a PBO bound the pointer is an offset into the buffer
+        const void* levelSource = source ? (const void*)(source + level.offset) : (const void*)(uintptr_t)level.offset;
+
+        if (data.format == TextureFormat::RGBA8) {
+            glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, levelSource);
+        }
+        else {
+            GLenum format = data.format == TextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            glCompressedTexImage2D(GL_TEXTURE_2D, l, format, level.width, level.height, 0, level.size, levelSource);
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, data.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void TextureManager::release()
+{
+    for (auto& texture : textures) {
+        glDeleteTextures(1, &texture.second);
+    }
+    textures.clear();
+    uploads.clear();
+
+    if (pixelBuffers[0]) {
+        glDeleteBuffers(numPixelBuffers, pixelBuffers);
+        for (unsigned int& buffer : pixelBuffers) {
+            buffer = 0;
+        }
+    }
+}
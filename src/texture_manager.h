@@ -0,0 +1,72 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "jobs/thread_pool.h"
+#include "jobs/mpsc_queue.h"
+#include "texture_compression.h"
+
+// A mip chain loaded on a worker, waiting for its upload on the render thread
+struct DecodedImage
+{
+    unsigned int texture = 0;
+    std::string path;
+    bool loaded = false;
+    TextureData data;
+};
+
+// Loads textures without stalling the render thread. Images are decoded on worker threads
+// and uploaded through pixel buffer objects, a limited number of bytes per frame. Every
+// texture is usable straight away, showing a 1x1 placeholder until its image arrives.
+//
+// The first load of an image cooks it into a block compressed mip chain stored next to
+// it, which later runs read directly. Drivers without S3TC get the chain decoded back to RGBA8
+class TextureManager
+{
+    public:
+        // Limits uploads to roughly uploadBudget bytes per frame, though at least one
+        // image is always uploaded so large images still make progress. Must be created
+        // on the render thread
+        TextureManager(unsigned numThreads = 0, size_t uploadBudget = 8 * 1024 * 1024, bool compress = true);
+
+        // Returns the texture for the image at path, starting its load the first time the
+        // path is seen. Must be called on the render thread
+        unsigned int load(const std::string& path);
+
+        // Uploads decoded images within the frame budget. Call once per frame on the render thread
+        void update();
+
+        // Images still being decoded or waiting for upload
+        unsigned pending() const { return inFlight.load(std::memory_order_relaxed) + uploads.size(); }
+
+        void release();
+
+    private:
+        void upload(DecodedImage& image);
+        // Runs on a worker thread
+        void decode(DecodedImage& image) const;
+
+        std::unordered_map<std::string, unsigned int> textures;
+        std::deque<DecodedImage> uploads;
+        size_t uploadBudget;
+        bool compress;
+        bool compressionSupported;
+
+        // Uploads cycle through several buffers so the driver can still be reading from
+        // one while the next is filled
+        static constexpr unsigned numPixelBuffers = 3;
+        unsigned int pixelBuffers[numPixelBuffers] = {};
+        unsigned nextPixelBuffer = 0;
+
+        // Declared before the pool so that it outlives any running worker
+        MPSCQueue<DecodedImage> decoded;
+        std::atomic<unsigned> inFlight;
+
+        ThreadPool pool;
+};
+
+#endif
@@ -1,12 +1,17 @@
 #ifndef VERTEX_H
 #define VERTEX_H
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
 struct vertex
 {
     float x, y, z;
     float u, v;
     float nx, ny, nz;
 
+    vertex() = default;
     vertex(float x, float y, float z, float u, float v, float nx, float ny, float nz)
         : x(x), y(y), z(z), u(u), v(v), nx(nx), ny(ny), nz(nz)
     {
@@ -17,13 +22,41 @@ struct vertex
     }
 };
 
+// Mixes all 256 bits of the vertex, so nearby vertices differing in a single low
+// mantissa bit still land far apart. Adding zero maps -0 onto +0 to agree with operator==
+inline uint64_t hashVertex(const vertex& vert)
+{
+    const float components[8] = {
+        vert.x + 0.0f, vert.y + 0.0f, vert.z + 0.0f, vert.u + 0.0f,
+        vert.v + 0.0f, vert.nx + 0.0f, vert.ny + 0.0f, vert.nz + 0.0f
+    };
+    uint64_t words[4];
+    std::memcpy(words, components, sizeof(words));
+
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 4; i++) {
+        uint64_t k = words[i] * 0x87C37B91114253D5ull;
+        k = (k << 31) | (k >> 33);
+        k *= 0x4CF5AD432745937Full;
+        h ^= k;
+        h = ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+    }
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
 namespace std {
     template <>
     struct hash<vertex> {
         size_t operator()(const vertex& v) const {
-            return hash<float>()(v.x) ^ (hash<float>()(v.y) << 1) ^ (hash<float>()(v.z) << 2) ^ (hash<float>()(v.u) << 3) ^ (hash<float>()(v.v) << 4) ^ (hash<float>()(v.nx) << 5) ^ (hash<float>()(v.ny) << 6) ^ (hash<float>()(v.nz) << 7);
+            return (size_t)hashVertex(v);
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -3,24 +3,73 @@
 
 #include <vector>
 #include <cmath>
+#include <functional>
 
 #include "maths/maths.h"
 #include "shaders/shader.h"
+#include "chunk_mesh.h"
+#include "heightmap.h"
+#include "noise/fractal_noise.h"
+
+struct ChunkCoord
+{
+    int x, y;
+
+    bool operator==(const ChunkCoord& other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+namespace std {
+    template <>
+    struct hash<ChunkCoord> {
+        size_t operator()(const ChunkCoord& c) const {
+            return hash<long long>()(((long long)c.x << 32) ^ (unsigned)c.y);
+        }
+    };
+}
 
 class World
 {
     public:
-        World(const unsigned seed, const unsigned chunkSize, const unsigned blockSize, const unsigned octaves);
-        std::vector<std::vector<float>> generateChunk(int chunk_x, int chunk_y);
-        float interpolate(float a0, float a1, float w);
-        vec2 randomGradient(int ix, int iy);
-        void drawChunk(std::vector<std::vector<float>> chunk, Shader& shader);
+        World(const unsigned seed, const unsigned chunkSize, const unsigned blockSize, const unsigned octaves,
+            const float lacunarity = 2.0f, const float gain = 0.5f);
+        // Returns the chunk's heights with a one sample apron around the mesh area
+        Heightmap generateChunk(int chunk_x, int chunk_y) const;
+        void buildChunkMesh(const HeightmapView& chunk, ChunkMesh& mesh) const;
+        // Sets the terrain uniforms shared by every chunk. The shader must be in use
+        void setTerrainUniforms(Shader& shader) const
+        {
+            shader.setVec2("heightRange", vec2(getMinHeight(), getMaxHeight() - getMinHeight()));
+        }
+
+        // Width of a chunk in world units along x and z
+        unsigned getChunkWidth() const { return blockSize * chunkSize; }
+        vec3 getChunkOrigin(int chunk_x, int chunk_y) const;
+
+        unsigned getActiveOctaves() const { return noise.getActiveOctaves(); }
+
+        // Terrain height at a world position, interpolated between the surrounding samples
+        float getHeight(float x, float z) const;
+
+        // Deterministic transforms for count objects scattered over the terrain within
+        // radius of the origin, with a random yaw and scale in [minScale, maxScale]
+        std::vector<mat4> scatterInstances(unsigned count, float radius, unsigned scatterSeed,
+            float minScale = 0.8f, float maxScale = 1.2f) const;
+
+        // Lowest and highest possible terrain height, used to quantise vertex heights
+        float getMinHeight() const { return -noise.getMaxValue(); }
+        float getMaxHeight() const { return noise.getMaxValue(); }
 
     private:
         unsigned seed;
         unsigned chunkSize;
         unsigned blockSize;
         unsigned octaves;
+
+        FractalNoise noise;
+
+        static FractalNoiseSettings makeNoiseSettings(unsigned octaves, float lacunarity, float gain);
 };  
 
 #endif
\ No newline at end of file